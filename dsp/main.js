@@ -1,6 +1,28 @@
+import { Renderer, el } from '@elemaudio/core';
+
 // Importing axios to handle HTTP requests
 import axios from 'axios';
 
+// The native side applies each instruction batch to the Elementary runtime that
+// processBlock renders, so the graph below is what the plugin plays.
+const core = new Renderer((batch) => {
+  __postNativeMessage__('renderInstructions', batch);
+});
+
+function renderGraph() {
+  core.render(
+    el.in({ channel: 0 }),
+    el.in({ channel: 1 }),
+  );
+}
+
+// Sent by native whenever the runtime or the plugin state changes
+globalThis.__receiveStateChange__ = () => {
+  renderGraph();
+};
+
+renderGraph();
+
 // Setting up API endpoints
 const API_BASE_URL = 'http://ableton-chat-01-72c15f63599a.herokuapp.com';
 const API_SEND_ENDPOINT = `${API_BASE_URL}/messages/send`;
@@ -46,5 +68,8 @@ globalThis.__sendMessage__ = (serializedMessage) => {
   sendMessageToAPI(username, message);
 };
 
-// Set an interval to fetch new messages periodically, ensuring new data is regularly fetched
-setInterval(fetchNewMessages, 10000);
+// Set an interval to fetch new messages periodically, ensuring new data is regularly fetched.
+// The embedded engine has no timers, in which case native does the polling.
+if (typeof setInterval === 'function') {
+  setInterval(fetchNewMessages, 10000);
+}
@@ -0,0 +1,97 @@
+#include "AssetCache.h"
+
+#include <map>
+#include <mutex>
+
+//==============================================================================
+std::shared_ptr<AssetCache> AssetCache::getFor(juce::File const& directory)
+{
+    static std::mutex mutex;
+    static std::map<juce::String, std::shared_ptr<AssetCache>> caches;
+
+    const std::lock_guard<std::mutex> lock(mutex);
+    auto& cache = caches[directory.getFullPathName()];
+
+    if (cache == nullptr)
+        cache = std::make_shared<AssetCache>(directory);
+
+    return cache;
+}
+
+std::string_view AssetCache::getMimeType(std::string_view extension)
+{
+    static const std::unordered_map<std::string_view, std::string_view> mimeTypes {
+        { ".html",   "text/html" },
+        { ".js",     "application/javascript" },
+        { ".mjs",    "application/javascript" },
+        { ".css",    "text/css" },
+        { ".json",   "application/json" },
+        { ".map",    "application/json" },
+        { ".svg",    "image/svg+xml" },
+        { ".png",    "image/png" },
+        { ".jpg",    "image/jpeg" },
+        { ".jpeg",   "image/jpeg" },
+        { ".gif",    "image/gif" },
+        { ".webp",   "image/webp" },
+        { ".ico",    "image/x-icon" },
+        { ".woff",   "font/woff" },
+        { ".woff2",  "font/woff2" },
+        { ".ttf",    "font/ttf" },
+        { ".otf",    "font/otf" },
+        { ".wasm",   "application/wasm" },
+        { ".txt",    "text/plain" },
+    };
+
+    auto it = mimeTypes.find(extension);
+    return it != mimeTypes.end() ? it->second : "application/octet-stream";
+}
+
+//==============================================================================
+AssetCache::AssetCache(juce::File const& directory)
+{
+    auto const startTicks = juce::Time::getHighResolutionTicks();
+
+    for (auto const& entry : juce::RangedDirectoryIterator(directory, true, "*", juce::File::findFiles)) {
+        auto const& file = entry.getFile();
+        juce::MemoryBlock mb;
+
+        if (!file.loadFileAsData(mb))
+            continue;
+
+        auto data = std::make_shared<std::vector<uint8_t>>(static_cast<const uint8_t*>(mb.getData()),
+                                                           static_cast<const uint8_t*>(mb.getData()) + mb.getSize());
+        auto path = "/" + file.getRelativePathFrom(directory).replaceCharacter('\\', '/').toStdString();
+        auto extension = file.getFileExtension().toLowerCase().toStdString();
+
+        totalBytes += data->size();
+        assets[path] = { std::move(data), std::string(getMimeType(extension)) };
+    }
+
+    buildMs = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) * 1000.0;
+
+    DBG("AssetCache: " << (int) assets.size() << " assets, " << (juce::int64) totalBytes << " bytes in " << buildMs << " ms");
+}
+
+//==============================================================================
+const AssetCache::Asset* AssetCache::find(std::string_view path) const
+{
+    if (path == "/" || path.empty())
+        path = "/index.html";
+
+    // Query strings and fragments do not name different files
+    path = path.substr(0, path.find_first_of("?#"));
+
+    auto it = assets.find(std::string(path));
+    return it != assets.end() ? &it->second : nullptr;
+}
+
+void AssetCache::noteServed(size_t numBytes)
+{
+    ++requestsServed;
+    bytesServed += numBytes;
+}
+
+AssetCache::Stats AssetCache::getStats() const
+{
+    return { assets.size(), totalBytes, buildMs, requestsServed.load(), bytesServed.load() };
+}
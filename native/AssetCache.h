@@ -0,0 +1,69 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+
+//==============================================================================
+// An immutable, in-memory copy of the editor's static assets (the dist/ folder).
+//
+// The first editor to open reads the whole directory once; every later editor,
+// in any plugin instance in the process, serves its requests from the same
+// shared cache without touching the disk. MIME types are resolved when the
+// cache is built, not per request.
+class AssetCache
+{
+public:
+    //==============================================================================
+    struct Asset
+    {
+        std::shared_ptr<const std::vector<uint8_t>> data;
+        std::string mimeType;
+    };
+
+    struct Stats
+    {
+        size_t numAssets = 0;
+        size_t totalBytes = 0;
+        double buildMs = 0.0;
+        uint64_t requestsServed = 0;
+        uint64_t bytesServed = 0;
+    };
+
+    //==============================================================================
+    // Returns the process-wide cache for the given directory, building it on
+    // first use. Safe from any thread.
+    static std::shared_ptr<AssetCache> getFor(juce::File const& directory);
+
+    static std::string_view getMimeType(std::string_view extension);
+
+    //==============================================================================
+    // Looks up a request path such as "/index.html" ("/" maps to index.html).
+    // Returns nullptr for anything that was not in the directory.
+    const Asset* find(std::string_view path) const;
+
+    // Counts a response of the given size for getStats()
+    void noteServed(size_t numBytes);
+
+    Stats getStats() const;
+
+    //==============================================================================
+    explicit AssetCache(juce::File const& directory);
+
+private:
+    //==============================================================================
+    std::unordered_map<std::string, Asset> assets;
+    size_t totalBytes = 0;
+    double buildMs = 0.0;
+
+    std::atomic<uint64_t> requestsServed { 0 };
+    std::atomic<uint64_t> bytesServed { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AssetCache)
+};
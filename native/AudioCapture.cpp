@@ -0,0 +1,201 @@
+#include "AudioCapture.h"
+
+namespace
+{
+    // How often the encoder looks for new audio
+    constexpr int kPollIntervalMs = 10;
+}
+
+//==============================================================================
+AudioCapture::AudioCapture()
+    : juce::Thread("AudioCapture"),
+      alive(std::make_shared<std::atomic<bool>>(true))
+{
+    // Started by the first capture
+}
+
+AudioCapture::~AudioCapture()
+{
+    alive->store(false);
+    armed = false;
+    stopThread(2000);
+}
+
+//==============================================================================
+void AudioCapture::prepare(double newSampleRate, int numChannels, double ringSeconds)
+{
+    cancel();
+
+    // A cancelled capture is discarded by the encoder; wait for it to let go
+    // of the ring before it is reallocated.
+    for (int i = 0; busy.load() && i < 200; ++i)
+        juce::Thread::sleep(kPollIntervalMs);
+
+    const juce::ScopedLock sl(encoderLock);
+
+    sampleRate = newSampleRate;
+
+    auto const capacity = juce::jmax(1024, static_cast<int>(std::ceil(sampleRate * ringSeconds)));
+    ring.setSize(juce::jmax(1, numChannels), capacity);
+    fifo.setTotalSize(capacity);
+}
+
+bool AudioCapture::start(double seconds, Completion onComplete)
+{
+    if (busy.load() || sampleRate <= 0.0)
+        return false;
+
+    seconds = juce::jlimit(0.1, kMaxSeconds, seconds);
+
+    {
+        const juce::ScopedLock sl(encoderLock);
+
+        encoded = std::make_unique<juce::MemoryBlock>();
+        juce::FlacAudioFormat flac;
+
+        // The writer owns the stream, which writes into `encoded`
+        writer.reset(flac.createWriterFor(new juce::MemoryOutputStream(*encoded, false),
+                                          sampleRate, static_cast<unsigned int>(ring.getNumChannels()), 24, {}, 0));
+
+        if (writer == nullptr) {
+            DBG("Could not create a FLAC writer");
+            encoded.reset();
+            return false;
+        }
+
+        completion = std::move(onComplete);
+        requestedSeconds = seconds;
+        encodeStartTicks = juce::Time::getHighResolutionTicks();
+    }
+
+    if (!isThreadRunning())
+        startThread(juce::Thread::Priority::low);
+
+    cancelRequested = false;
+    samplesToCapture = static_cast<juce::int64>(seconds * sampleRate);
+    busy = true;
+    armed.store(true, std::memory_order_release);
+    return true;
+}
+
+void AudioCapture::cancel()
+{
+    if (busy.load()) {
+        cancelRequested = true;
+        armed = false;
+    }
+}
+
+AudioCapture::Stats AudioCapture::getStats() const
+{
+    return { samplesCaptured.load(), samplesDropped.load(), snippetsEncoded.load(), lastEncodeMs.load(), lastEncodedBytes.load() };
+}
+
+//==============================================================================
+void AudioCapture::push(const float* const* channels, int numChannels, int numSamples) noexcept
+{
+    if (!armed.load(std::memory_order_acquire))
+        return;
+
+    auto const remaining = samplesToCapture.load(std::memory_order_relaxed);
+    auto const wanted = static_cast<int>(std::min<juce::int64>(remaining, numSamples));
+    auto const numRingChannels = ring.getNumChannels();
+
+    int written = 0;
+
+    {
+        const juce::AbstractFifo::ScopedWrite write(fifo, wanted);
+        written = write.blockSize1 + write.blockSize2;
+
+        for (int ch = 0; ch < numRingChannels; ++ch) {
+            // Channels the host did not provide are recorded as silence
+            if (ch < numChannels) {
+                if (write.blockSize1 > 0)
+                    ring.copyFrom(ch, write.startIndex1, channels[ch], write.blockSize1);
+
+                if (write.blockSize2 > 0)
+                    ring.copyFrom(ch, write.startIndex2, channels[ch] + write.blockSize1, write.blockSize2);
+            } else {
+                if (write.blockSize1 > 0)
+                    ring.clear(ch, write.startIndex1, write.blockSize1);
+
+                if (write.blockSize2 > 0)
+                    ring.clear(ch, write.startIndex2, write.blockSize2);
+            }
+        }
+    }
+
+    if (written < wanted)
+        samplesDropped.fetch_add(static_cast<uint64_t>(wanted - written), std::memory_order_relaxed);
+
+    samplesCaptured.fetch_add(static_cast<uint64_t>(written), std::memory_order_relaxed);
+    samplesToCapture.store(remaining - wanted, std::memory_order_relaxed);
+
+    if (remaining - wanted <= 0)
+        armed.store(false, std::memory_order_release);
+}
+
+//==============================================================================
+void AudioCapture::run()
+{
+    while (!threadShouldExit()) {
+        wait(kPollIntervalMs);
+
+        if (!busy.load())
+            continue;
+
+        const juce::ScopedLock sl(encoderLock);
+        drainRing();
+
+        // Done once the audio thread has stopped writing and the ring is empty
+        if (!armed.load(std::memory_order_acquire) && fifo.getNumReady() == 0)
+            finish();
+    }
+}
+
+void AudioCapture::drainRing()
+{
+    auto const ready = fifo.getNumReady();
+
+    if (ready == 0)
+        return;
+
+    const juce::AbstractFifo::ScopedRead read(fifo, ready);
+
+    if (writer == nullptr || cancelRequested.load())
+        return;
+
+    auto write = [this](int start, int size) {
+        if (size > 0) {
+            juce::AudioBuffer<float> region(ring.getArrayOfWritePointers(), ring.getNumChannels(), start, size);
+            writer->writeFromAudioSampleBuffer(region, 0, size);
+        }
+    };
+
+    write(read.startIndex1, read.blockSize1);
+    write(read.startIndex2, read.blockSize2);
+}
+
+void AudioCapture::finish()
+{
+    // Flushes the FLAC stream into `encoded`
+    writer.reset();
+
+    auto const cancelled = cancelRequested.load();
+    auto result = std::shared_ptr<juce::MemoryBlock>(std::move(encoded));
+    auto onComplete = std::move(completion);
+    completion = nullptr;
+
+    if (!cancelled && result != nullptr) {
+        ++snippetsEncoded;
+        lastEncodeMs = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - encodeStartTicks) * 1000.0;
+        lastEncodedBytes = result->getSize();
+
+        juce::MessageManager::callAsync([flag = alive, result, onComplete, seconds = requestedSeconds] {
+            if (flag->load() && onComplete != nullptr)
+                onComplete(*result, seconds);
+        });
+    }
+
+    busy = false;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_audio_formats/juce_audio_formats.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+
+//==============================================================================
+// Records a few seconds of the plugin's output and encodes it to FLAC.
+//
+// The audio thread only copies into a preallocated ring through a
+// juce::AbstractFifo: no allocation, no lock and no waiting, not even to wake
+// the encoder, which polls instead. If the ring is ever full the samples that do
+// not fit are dropped and counted rather than waited for. The encoder thread
+// streams whatever is in the ring into a FLAC writer as it arrives and, once the
+// requested length has been captured, hands the encoded file to the message
+// thread.
+class AudioCapture : private juce::Thread
+{
+public:
+    //==============================================================================
+    // Called on the message thread with the encoded FLAC file and its length.
+    using Completion = std::function<void(juce::MemoryBlock const& flac, double seconds)>;
+
+    struct Stats
+    {
+        uint64_t samplesCaptured = 0;
+        uint64_t samplesDropped = 0;
+        uint64_t snippetsEncoded = 0;
+        double lastEncodeMs = 0.0;
+        size_t lastEncodedBytes = 0;
+    };
+
+    //==============================================================================
+    AudioCapture();
+    ~AudioCapture() override;
+
+    //==============================================================================
+    // Not real-time safe; cancels any capture in progress. The ring holds
+    // ringSeconds of audio, which only needs to cover the encoder's worst stall.
+    void prepare(double sampleRate, int numChannels, double ringSeconds = 4.0);
+
+    // Message thread. Returns false if a capture is still running or the
+    // capture has not been prepared.
+    bool start(double seconds, Completion onComplete);
+    void cancel();
+
+    bool isCapturing() const { return busy.load(); }
+
+    // Audio thread.
+    void push(const float* const* channels, int numChannels, int numSamples) noexcept;
+
+    Stats getStats() const;
+
+    static constexpr double kMaxSeconds = 30.0;
+
+private:
+    //==============================================================================
+    void run() override;
+    void drainRing();
+    void finish();
+
+    //==============================================================================
+    double sampleRate = 0.0;
+    juce::AbstractFifo fifo { 1 };
+    juce::AudioBuffer<float> ring;
+
+    // Set by start(); cleared by the audio thread once the last sample is in
+    std::atomic<bool> armed { false };
+    std::atomic<bool> cancelRequested { false };
+    std::atomic<juce::int64> samplesToCapture { 0 };
+
+    // From start() until the encoded file has been handed over
+    std::atomic<bool> busy { false };
+
+    // Encoder thread while busy; set up by start() before busy is raised
+    juce::CriticalSection encoderLock;
+    std::unique_ptr<juce::AudioFormatWriter> writer;
+    std::unique_ptr<juce::MemoryBlock> encoded;
+    Completion completion;
+    double requestedSeconds = 0.0;
+    juce::int64 encodeStartTicks = 0;
+
+    std::atomic<uint64_t> samplesCaptured { 0 };
+    std::atomic<uint64_t> samplesDropped { 0 };
+    std::atomic<uint64_t> snippetsEncoded { 0 };
+    std::atomic<double> lastEncodeMs { 0.0 };
+    std::atomic<size_t> lastEncodedBytes { 0 };
+
+    std::shared_ptr<std::atomic<bool>> alive;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioCapture)
+};
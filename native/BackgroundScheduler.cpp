@@ -0,0 +1,232 @@
+#include "BackgroundScheduler.h"
+#include "Trace.h"
+
+#include <algorithm>
+
+namespace
+{
+    // Share of a tick's frame the scheduled work may use before the rest waits
+    // for the next tick. Essential work is not counted against it.
+    constexpr double kNormalBudgetMs = 4.0;
+    constexpr double kThrottledBudgetMs = 1.0;
+
+    // DSP load, in percent, at which background work starts to yield, and at
+    // which it stops again
+    constexpr double kBusyEnterLoad = 70.0;
+    constexpr double kBusyExitLoad = 50.0;
+
+    // Normal-priority intervals are stretched by this much while busy
+    constexpr int kBusyIntervalFactor = 4;
+
+    bool isDue(juce::uint32 dueMs, juce::uint32 nowMs)
+    {
+        return static_cast<juce::int32>(nowMs - dueMs) >= 0;
+    }
+}
+
+//==============================================================================
+BackgroundScheduler::BackgroundScheduler(LoadSource source)
+    : loadSource(std::move(source))
+{
+}
+
+BackgroundScheduler::~BackgroundScheduler()
+{
+    stopTimer();
+}
+
+//==============================================================================
+void BackgroundScheduler::addTask(std::string name, Priority priority, int intervalMs, std::function<void()> fn)
+{
+    auto task = std::make_unique<Task>();
+    task->name = std::move(name);
+    task->priority = priority;
+    task->intervalMs = std::max(1, intervalMs);
+    task->fn = std::move(fn);
+    task->dueMs = juce::Time::getMillisecondCounter() + static_cast<juce::uint32>(task->intervalMs);
+    tasks.push_back(std::move(task));
+}
+
+void BackgroundScheduler::post(std::string name, Priority priority, std::function<void()> fn)
+{
+    // A job whose fn has been taken is running or done, and is not reused
+    for (auto& task : tasks) {
+        if (task->once && task->fn != nullptr && task->name == name) {
+            task->priority = priority;
+            task->fn = std::move(fn);
+            return;
+        }
+    }
+
+    auto task = std::make_unique<Task>();
+    task->name = std::move(name);
+    task->priority = priority;
+    task->fn = std::move(fn);
+    task->dueMs = juce::Time::getMillisecondCounter();
+    task->once = true;
+    tasks.push_back(std::move(task));
+}
+
+void BackgroundScheduler::start()
+{
+    if (isTimerRunning())
+        return;
+
+    auto const now = juce::Time::getMillisecondCounter();
+
+    for (auto& task : tasks)
+        if (!task->once)
+            task->dueMs = now + static_cast<juce::uint32>(task->intervalMs);
+
+    // The first tick tells the listener again if it is not normal
+    mode = Mode::normal;
+    startTimer(kTickMs);
+}
+
+void BackgroundScheduler::stop()
+{
+    stopTimer();
+}
+
+//==============================================================================
+BackgroundScheduler::Mode BackgroundScheduler::chooseMode(double load) const
+{
+    if (!throttlingEnabled)
+        return Mode::normal;
+
+    if (renderingOffline.load())
+        return Mode::offline;
+
+    if (mode == Mode::busy)
+        return load < kBusyExitLoad ? Mode::normal : Mode::busy;
+
+    return load > kBusyEnterLoad ? Mode::busy : Mode::normal;
+}
+
+bool BackgroundScheduler::isAllowed(Task const& task, Mode currentMode) const
+{
+    switch (task.priority) {
+        case Priority::essential:  return true;
+        case Priority::normal:     return currentMode != Mode::offline;
+        case Priority::background: return currentMode == Mode::normal;
+    }
+
+    return true;
+}
+
+void BackgroundScheduler::timerCallback()
+{
+    ELEM_TRACE_SPAN("scheduler", "scheduler.tick");
+    auto const startTicks = juce::Time::getHighResolutionTicks();
+
+    auto elapsedMs = [startTicks] {
+        return juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) * 1000.0;
+    };
+
+    auto const load = loadSource != nullptr ? loadSource() : 0.0;
+    auto const nextMode = chooseMode(load);
+    stats.recentLoad = load;
+
+    if (nextMode != mode) {
+        mode = nextMode;
+        ++stats.modeChanges;
+
+        if (modeListener != nullptr)
+            modeListener(mode);
+    }
+
+    auto const now = juce::Time::getMillisecondCounter();
+    order.clear();
+
+    for (auto& task : tasks)
+        if (task->fn != nullptr && isDue(task->dueMs, now))
+            order.push_back(task.get());
+
+    std::sort(order.begin(), order.end(), [](Task const* a, Task const* b) {
+        if (a->priority != b->priority)
+            return a->priority < b->priority;
+
+        return static_cast<juce::int32>(a->dueMs - b->dueMs) < 0;
+    });
+
+    auto const budgetMs = mode == Mode::normal ? kNormalBudgetMs : kThrottledBudgetMs;
+
+    for (auto* task : order) {
+        if (!isAllowed(*task, mode) || (task->priority != Priority::essential && elapsedMs() >= budgetMs)) {
+            task->deferred = true;
+            ++stats.tasksDeferred;
+            continue;
+        }
+
+        if (task->deferred) {
+            task->deferred = false;
+            ++stats.catchUpRuns;
+        }
+
+        ++stats.tasksRun;
+
+        // Taken out first: fn may post or add work, including a job of its own name
+        std::function<void()> fn;
+
+        if (task->once) {
+            fn = std::move(task->fn);
+            task->fn = nullptr;
+        } else {
+            auto const interval = task->intervalMs * (mode == Mode::busy && task->priority == Priority::normal ? kBusyIntervalFactor : 1);
+            task->dueMs = now + static_cast<juce::uint32>(interval);
+        }
+
+        try {
+            (fn != nullptr ? fn : task->fn)();
+        } catch (const std::exception& e) {
+            DBG("Exception in scheduled task " << juce::String(task->name) << ": " << e.what());
+        } catch (...) {
+            DBG("Unknown exception in scheduled task " << juce::String(task->name));
+        }
+    }
+
+    tasks.erase(std::remove_if(tasks.begin(), tasks.end(), [](auto const& task) {
+        return task->once && task->fn == nullptr;
+    }), tasks.end());
+
+    auto const tickMs = elapsedMs();
+    ++stats.ticks;
+    stats.maxTickMs = std::max(stats.maxTickMs, tickMs);
+
+    if (tickMs > budgetMs)
+        ++stats.ticksOverBudget;
+}
+
+//==============================================================================
+BackgroundScheduler::Stats BackgroundScheduler::getStats() const
+{
+    auto result = stats;
+    result.mode = mode;
+    return result;
+}
+
+char const* BackgroundScheduler::toString(Mode m)
+{
+    switch (m) {
+        case Mode::normal:  return "normal";
+        case Mode::busy:    return "busy";
+        case Mode::offline: return "offline";
+    }
+
+    return "normal";
+}
+
+juce::var BackgroundScheduler::toVar(Stats const& stats)
+{
+    auto* result = new juce::DynamicObject();
+    result->setProperty("mode", toString(stats.mode));
+    result->setProperty("recentLoad", stats.recentLoad);
+    result->setProperty("modeChanges", static_cast<juce::int64>(stats.modeChanges));
+    result->setProperty("ticks", static_cast<juce::int64>(stats.ticks));
+    result->setProperty("ticksOverBudget", static_cast<juce::int64>(stats.ticksOverBudget));
+    result->setProperty("maxTickMs", stats.maxTickMs);
+    result->setProperty("tasksRun", static_cast<juce::int64>(stats.tasksRun));
+    result->setProperty("tasksDeferred", static_cast<juce::int64>(stats.tasksDeferred));
+    result->setProperty("catchUpRuns", static_cast<juce::int64>(stats.catchUpRuns));
+    return juce::var(result);
+}
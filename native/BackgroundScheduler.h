@@ -0,0 +1,136 @@
+#pragma once
+
+#include <juce_events/juce_events.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+//==============================================================================
+// Runs an instance's non-audio work from one message-thread timer, so that it
+// can be held back while the audio side needs the CPU.
+//
+// Work is either a periodic task or a one-shot job, each with a priority. Every
+// tick (one display frame) the scheduler picks a mode and runs what is due,
+// highest priority and most overdue first, until the tick's time budget is
+// spent; essential work always runs.
+//
+//   normal   everything runs at its own interval
+//   busy     the recent DSP load is high: normal work runs at a quarter of its
+//            rate and background work waits
+//   offline  the host is rendering faster than real time: only essential work
+//            runs
+//
+// Work that waits is not repeated for every interval it missed; it runs once,
+// as soon as the mode allows, and then resumes its interval. The owner is told
+// about mode changes, for work that is not run from here, such as a shared
+// poll.
+//
+// Message thread only, except for setRenderingOffline().
+class BackgroundScheduler : private juce::Timer
+{
+public:
+    //==============================================================================
+    enum class Priority
+    {
+        essential,
+        normal,
+        background,
+    };
+
+    enum class Mode
+    {
+        normal,
+        busy,
+        offline,
+    };
+
+    // The DSP load (percent of the real-time budget) of the last few blocks
+    using LoadSource = std::function<double()>;
+    using ModeListener = std::function<void(Mode)>;
+
+    struct Stats
+    {
+        Mode mode = Mode::normal;
+        double recentLoad = 0.0;
+        uint64_t modeChanges = 0;
+
+        uint64_t ticks = 0;
+        uint64_t ticksOverBudget = 0;
+        double maxTickMs = 0.0;
+
+        uint64_t tasksRun = 0;
+
+        // Due work that was held back, once per tick; and the runs that then
+        // made up for it
+        uint64_t tasksDeferred = 0;
+        uint64_t catchUpRuns = 0;
+    };
+
+    static constexpr int kTickMs = 16;
+
+    //==============================================================================
+    explicit BackgroundScheduler(LoadSource loadSource);
+    ~BackgroundScheduler() override;
+
+    //==============================================================================
+    // The first run is due one interval after the scheduler starts.
+    void addTask(std::string name, Priority priority, int intervalMs, std::function<void()> fn);
+
+    // Runs fn once, at the next tick that allows it. A job still waiting under
+    // the same name is replaced, so repeated requests collapse into one.
+    void post(std::string name, Priority priority, std::function<void()> fn);
+
+    void start();
+    void stop();
+
+    // Any thread; the mode follows at the next tick.
+    void setRenderingOffline(bool isOffline) { renderingOffline = isOffline; }
+
+    // Off keeps the scheduler in normal mode whatever the load, e.g. to measure
+    // what the throttling buys.
+    void setThrottlingEnabled(bool shouldThrottle) { throttlingEnabled = shouldThrottle; }
+    void setModeListener(ModeListener listener) { modeListener = std::move(listener); }
+
+    Mode getMode() const { return mode; }
+    Stats getStats() const;
+
+    static char const* toString(Mode mode);
+    static juce::var toVar(Stats const& stats);
+
+private:
+    //==============================================================================
+    struct Task
+    {
+        std::string name;
+        Priority priority = Priority::normal;
+        int intervalMs = 0;
+        std::function<void()> fn;
+
+        juce::uint32 dueMs = 0;
+        bool once = false;
+        bool deferred = false;
+    };
+
+    void timerCallback() override;
+    Mode chooseMode(double load) const;
+    bool isAllowed(Task const& task, Mode mode) const;
+
+    //==============================================================================
+    LoadSource loadSource;
+    ModeListener modeListener;
+
+    std::vector<std::unique_ptr<Task>> tasks;
+    std::vector<Task*> order;
+
+    std::atomic<bool> renderingOffline { false };
+    bool throttlingEnabled = true;
+    Mode mode = Mode::normal;
+
+    Stats stats;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BackgroundScheduler)
+};
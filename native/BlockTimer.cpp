@@ -0,0 +1,169 @@
+#include "BlockTimer.h"
+
+namespace
+{
+    // A callback arriving more than this many block lengths after the previous
+    // one suggests the host dropped out in between.
+    constexpr double kLateCallbackFactor = 2.0;
+
+    // Weight of each block in the recent load, about a 20-block window
+    constexpr double kRecentLoadSmoothing = 0.05;
+
+    // A recent load older than this no longer says anything about the host
+    constexpr double kRecentLoadExpirySeconds = 0.5;
+
+    // Single writer: a plain load and store is enough, and cheaper than an RMW
+    template <typename T>
+    void bump(std::atomic<T>& counter)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+}
+
+//==============================================================================
+void BlockTimer::prepare(double newSampleRate, int newBlockSize)
+{
+    sampleRate = newSampleRate;
+    blockSize = newBlockSize;
+    clear();
+}
+
+void BlockTimer::clear()
+{
+    blocks.store(0, std::memory_order_relaxed);
+    overruns.store(0, std::memory_order_relaxed);
+    lateCallbacks.store(0, std::memory_order_relaxed);
+    minSeconds.store(0.0, std::memory_order_relaxed);
+    maxSeconds.store(0.0, std::memory_order_relaxed);
+    sumSeconds.store(0.0, std::memory_order_relaxed);
+    sumLoad.store(0.0, std::memory_order_relaxed);
+    maxLoad.store(0.0, std::memory_order_relaxed);
+
+    for (auto& bucket : histogram)
+        bucket.store(0, std::memory_order_relaxed);
+
+    recentLoad.store(0.0, std::memory_order_relaxed);
+    lastStartTicks = 0;
+}
+
+//==============================================================================
+void BlockTimer::end(juce::int64 startTicks, int numSamples)
+{
+    auto const endTicks = juce::Time::getHighResolutionTicks();
+    auto const rate = sampleRate.load(std::memory_order_relaxed);
+
+    if (resetRequested.load(std::memory_order_relaxed) && resetRequested.exchange(false))
+        clear();
+
+    if (rate <= 0.0 || numSamples <= 0)
+        return;
+
+    auto const elapsed = double(endTicks - startTicks) / ticksPerSecond;
+    auto const budget = numSamples / rate;
+    auto const load = elapsed / budget * 100.0;
+
+    if (lastStartTicks != 0 && double(startTicks - lastStartTicks) / ticksPerSecond > kLateCallbackFactor * budget)
+        bump(lateCallbacks);
+
+    lastStartTicks = startTicks;
+
+    auto const count = blocks.load(std::memory_order_relaxed);
+
+    if (count == 0 || elapsed < minSeconds.load(std::memory_order_relaxed))
+        minSeconds.store(elapsed, std::memory_order_relaxed);
+
+    if (elapsed > maxSeconds.load(std::memory_order_relaxed))
+        maxSeconds.store(elapsed, std::memory_order_relaxed);
+
+    if (load > maxLoad.load(std::memory_order_relaxed))
+        maxLoad.store(load, std::memory_order_relaxed);
+
+    sumSeconds.store(sumSeconds.load(std::memory_order_relaxed) + elapsed, std::memory_order_relaxed);
+    sumLoad.store(sumLoad.load(std::memory_order_relaxed) + load, std::memory_order_relaxed);
+
+    if (elapsed > budget)
+        bump(overruns);
+
+    bump(histogram[size_t(juce::jlimit(0, kHistogramBuckets - 1, int(load)))]);
+
+    auto const previousLoad = recentLoad.load(std::memory_order_relaxed);
+    recentLoad.store(previousLoad + kRecentLoadSmoothing * (load - previousLoad), std::memory_order_relaxed);
+    lastEndTicks.store(endTicks, std::memory_order_relaxed);
+
+    // Published last, so a reader never sees a count ahead of the sums
+    blocks.store(count + 1, std::memory_order_release);
+}
+
+//==============================================================================
+BlockTimer::Stats BlockTimer::getStats() const
+{
+    Stats stats;
+    stats.sampleRate = sampleRate.load();
+    stats.blockSize = blockSize.load();
+    stats.budgetUs = stats.sampleRate > 0.0 ? stats.blockSize / stats.sampleRate * 1.0e6 : 0.0;
+
+    stats.blocks = blocks.load(std::memory_order_acquire);
+    stats.overruns = overruns.load(std::memory_order_relaxed);
+    stats.lateCallbacks = lateCallbacks.load(std::memory_order_relaxed);
+
+    if (stats.blocks == 0)
+        return stats;
+
+    stats.minUs = minSeconds.load(std::memory_order_relaxed) * 1.0e6;
+    stats.maxUs = maxSeconds.load(std::memory_order_relaxed) * 1.0e6;
+    stats.avgUs = sumSeconds.load(std::memory_order_relaxed) / double(stats.blocks) * 1.0e6;
+    stats.avgLoad = sumLoad.load(std::memory_order_relaxed) / double(stats.blocks);
+    stats.maxLoad = maxLoad.load(std::memory_order_relaxed);
+
+    // The histogram holds load rather than time, since blocks can vary in length;
+    // its p99 is converted to time against the nominal block.
+    uint64_t total = 0;
+
+    for (auto const& bucket : histogram)
+        total += bucket.load(std::memory_order_relaxed);
+
+    auto const threshold = (total * 99 + 99) / 100;
+    uint64_t cumulative = 0;
+
+    for (int i = 0; i < kHistogramBuckets; ++i) {
+        cumulative += histogram[size_t(i)].load(std::memory_order_relaxed);
+
+        if (cumulative >= threshold) {
+            // The bucket's upper edge, except that overflow reports the true maximum
+            stats.p99Load = i == kHistogramBuckets - 1 ? stats.maxLoad : double(i + 1);
+            break;
+        }
+    }
+
+    stats.p99Us = stats.p99Load / 100.0 * stats.budgetUs;
+    return stats;
+}
+
+double BlockTimer::getRecentLoad() const
+{
+    auto const endTicks = lastEndTicks.load(std::memory_order_relaxed);
+
+    if (endTicks == 0 || double(juce::Time::getHighResolutionTicks() - endTicks) / ticksPerSecond > kRecentLoadExpirySeconds)
+        return 0.0;
+
+    return recentLoad.load(std::memory_order_relaxed);
+}
+
+juce::var BlockTimer::toVar(Stats const& stats)
+{
+    auto* result = new juce::DynamicObject();
+    result->setProperty("sampleRate", stats.sampleRate);
+    result->setProperty("blockSize", stats.blockSize);
+    result->setProperty("budgetUs", stats.budgetUs);
+    result->setProperty("blocks", static_cast<juce::int64>(stats.blocks));
+    result->setProperty("overruns", static_cast<juce::int64>(stats.overruns));
+    result->setProperty("lateCallbacks", static_cast<juce::int64>(stats.lateCallbacks));
+    result->setProperty("minUs", stats.minUs);
+    result->setProperty("avgUs", stats.avgUs);
+    result->setProperty("maxUs", stats.maxUs);
+    result->setProperty("p99Us", stats.p99Us);
+    result->setProperty("avgLoad", stats.avgLoad);
+    result->setProperty("maxLoad", stats.maxLoad);
+    result->setProperty("p99Load", stats.p99Load);
+    return juce::var(result);
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <array>
+#include <atomic>
+
+
+//==============================================================================
+// Real-time safe instrumentation for processBlock.
+//
+// The audio thread brackets each block with begin()/end(). end() compares the
+// elapsed time with the block's real-time budget (its length at the prepared
+// sample rate) and records it in plain atomics: running min/max/sum, a histogram
+// of DSP load at 1% resolution, and counters for blocks that overran their budget
+// and callbacks that arrived late. The audio thread is the only writer, so this
+// is a handful of relaxed loads and stores per block with no locks or
+// allocation. Any thread can read a Stats snapshot; it may mix values from two
+// adjacent blocks, which is fine for monitoring.
+class BlockTimer
+{
+public:
+    //==============================================================================
+    struct Stats
+    {
+        double sampleRate = 0.0;
+        int blockSize = 0;
+        double budgetUs = 0.0;
+
+        uint64_t blocks = 0;
+        uint64_t overruns = 0;
+        uint64_t lateCallbacks = 0;
+
+        double minUs = 0.0;
+        double avgUs = 0.0;
+        double maxUs = 0.0;
+        double p99Us = 0.0;
+
+        // Elapsed time as a percentage of the block's budget
+        double avgLoad = 0.0;
+        double maxLoad = 0.0;
+        double p99Load = 0.0;
+    };
+
+    //==============================================================================
+    // Not real-time safe; called from prepareToPlay. Also resets the statistics.
+    void prepare(double sampleRate, int blockSize);
+
+    // Audio thread only.
+    juce::int64 begin() const { return juce::Time::getHighResolutionTicks(); }
+    void end(juce::int64 startTicks, int numSamples);
+
+    // Any thread. The audio thread clears the statistics at its next end().
+    void reset() { resetRequested = true; }
+
+    Stats getStats() const;
+
+    // Any thread. The load of the last few dozen blocks, smoothed, or 0 once the
+    // host has stopped calling processBlock for a while.
+    double getRecentLoad() const;
+
+    // The snapshot as a JSON-ready object, for the editor and the headless harness
+    static juce::var toVar(Stats const& stats);
+
+private:
+    //==============================================================================
+    static constexpr int kHistogramBuckets = 401; // 0..399% in 1% steps, then overflow
+
+    void clear();
+
+    //==============================================================================
+    std::atomic<double> sampleRate { 0.0 };
+    std::atomic<int> blockSize { 0 };
+    double ticksPerSecond = double(juce::Time::getHighResolutionTicksPerSecond());
+
+    std::atomic<bool> resetRequested { false };
+    juce::int64 lastStartTicks = 0;
+
+    std::atomic<uint64_t> blocks { 0 };
+    std::atomic<uint64_t> overruns { 0 };
+    std::atomic<uint64_t> lateCallbacks { 0 };
+    std::atomic<double> minSeconds { 0.0 };
+    std::atomic<double> maxSeconds { 0.0 };
+    std::atomic<double> sumSeconds { 0.0 };
+    std::atomic<double> sumLoad { 0.0 };
+    std::atomic<double> maxLoad { 0.0 };
+    std::array<std::atomic<uint32_t>, kHistogramBuckets> histogram {};
+
+    std::atomic<double> recentLoad { 0.0 };
+    std::atomic<juce::int64> lastEndTicks { 0 };
+};
@@ -0,0 +1,100 @@
+#include "ChatDeliveryQueue.h"
+
+namespace
+{
+    // How long to wait for the page to acknowledge a batch before assuming the ack
+    // was lost and sending the next one anyway.
+    constexpr juce::uint32 kAckTimeoutMs = 500;
+}
+
+//==============================================================================
+ChatDeliveryQueue::ChatDeliveryQueue(Sink s)
+    : sink(std::move(s))
+{
+}
+
+//==============================================================================
+void ChatDeliveryQueue::setMaxBatchSize(size_t numMessages)
+{
+    maxBatchSize = std::max<size_t>(1, numMessages);
+}
+
+void ChatDeliveryQueue::setMaxPending(size_t numMessages)
+{
+    maxPending = std::max<size_t>(1, numMessages);
+}
+
+void ChatDeliveryQueue::push(std::string serializedMessage)
+{
+    pending.push_back(std::move(serializedMessage));
+
+    while (pending.size() > maxPending) {
+        pending.pop_front();
+        ++stats.messagesDropped;
+    }
+}
+
+void ChatDeliveryQueue::acknowledge()
+{
+    awaitingAck = false;
+}
+
+void ChatDeliveryQueue::reset()
+{
+    pending.clear();
+    awaitingAck = false;
+}
+
+void ChatDeliveryQueue::service()
+{
+    if (awaitingAck) {
+        if (juce::Time::getMillisecondCounter() - batchSentAtMs < kAckTimeoutMs)
+            return;
+
+        awaitingAck = false;
+    }
+
+    flush();
+}
+
+void ChatDeliveryQueue::flush()
+{
+    if (pending.empty())
+        return;
+
+    const auto batchSize = std::min(pending.size(), maxBatchSize);
+
+    size_t numBytes = 64;
+    for (size_t i = 0; i < batchSize; ++i)
+        numBytes += pending[i].size() + 1;
+
+    std::string script;
+    script.reserve(numBytes);
+    script += "(function() {\n"
+              "  if (typeof globalThis.__receiveMessages__ !== 'function')\n"
+              "    return false;\n\n"
+              "  globalThis.__receiveMessages__([";
+
+    for (size_t i = 0; i < batchSize; ++i) {
+        if (i > 0)
+            script += ',';
+
+        script += pending[i];
+    }
+
+    script += "]);\n  return true;\n})();\n";
+
+    if (!sink(script)) {
+        stats.messagesDropped += pending.size();
+        pending.clear();
+        return;
+    }
+
+    pending.erase(pending.begin(), pending.begin() + static_cast<std::ptrdiff_t>(batchSize));
+
+    stats.messagesDelivered += batchSize;
+    ++stats.batchesDelivered;
+
+    awaitingAck = true;
+    batchSentAtMs = juce::Time::getMillisecondCounter();
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <juce_events/juce_events.h>
+
+#include <deque>
+#include <functional>
+#include <string>
+
+
+//==============================================================================
+// Coalesces outbound chat messages so that everything arriving within one display
+// frame reaches the WebView in a single __receiveMessages__([...]) call.
+//
+// Messages are pushed as already-serialized JSON objects. The owner calls service()
+// once per display frame, which joins up to maxBatchSize of them into one script
+// and hands it to the sink. After
+// a batch goes out, no further batch is sent until the page acknowledges it (or an
+// ack timeout passes), which keeps a slow editor from being flooded; if the backlog
+// grows past maxPending the oldest entries are dropped and counted.
+class ChatDeliveryQueue
+{
+public:
+    //==============================================================================
+    // Evaluates the given script in the editor. Returns false when there is no
+    // editor to deliver to, in which case the pending backlog is discarded.
+    using Sink = std::function<bool(std::string const& script)>;
+
+    struct Stats
+    {
+        uint64_t messagesDelivered = 0;
+        uint64_t batchesDelivered = 0;
+        uint64_t messagesDropped = 0;
+    };
+
+    //==============================================================================
+    explicit ChatDeliveryQueue(Sink sink);
+
+    //==============================================================================
+    void setMaxBatchSize(size_t numMessages);
+    void setMaxPending(size_t numMessages);
+
+    void push(std::string serializedMessage);
+
+    // Called when the page reports that it has applied the previous batch.
+    void acknowledge();
+
+    // Forgets any pending messages and outstanding ack, e.g. when the page reloads.
+    void reset();
+
+    // Sends the next batch, unless the previous one is still unacknowledged.
+    void service();
+
+    bool hasPending() const { return !pending.empty(); }
+
+    Stats getStats() const { return stats; }
+
+private:
+    //==============================================================================
+    void flush();
+
+    //==============================================================================
+    Sink sink;
+    std::deque<std::string> pending;
+
+    size_t maxBatchSize = 256;
+    size_t maxPending = 4096;
+
+    bool awaitingAck = false;
+    juce::uint32 batchSentAtMs = 0;
+
+    Stats stats;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ChatDeliveryQueue)
+};
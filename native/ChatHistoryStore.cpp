@@ -0,0 +1,136 @@
+#include "ChatHistoryStore.h"
+
+#include <algorithm>
+
+//==============================================================================
+ChatHistoryStore::ChatHistoryStore(size_t capacity)
+    : slots(std::max<size_t>(1, capacity))
+{
+}
+
+//==============================================================================
+uint64_t ChatHistoryStore::append(ChatMessage const& message)
+{
+    auto seq = nextSeq++;
+    auto& slot = slots[seq % slots.size()];
+
+    // Interned before the evicted message lets go of its id, so a sender who
+    // follows themselves around the ring keeps the same one
+    auto const nicknameId = intern(message.nickname);
+
+    if (count == slots.size())
+        release(slot.nicknameId);
+
+    // Assigning into the evicted slot's string reuses its buffer
+    slot.createdAt = message.createdAt;
+    slot.nicknameId = nicknameId;
+    slot.text.assign(message.text.data(), message.text.size());
+
+    count = std::min(count + 1, slots.size());
+    return seq;
+}
+
+void ChatHistoryStore::clear()
+{
+    count = 0;
+
+    for (auto& slot : slots)
+        slot.text.clear();
+
+    nicknames.clear();
+    freeNicknameIds.clear();
+    nicknameIds.clear();
+}
+
+//==============================================================================
+void ChatHistoryStore::getMessages(uint64_t beforeSeq, size_t maxCount, std::vector<Entry>& out) const
+{
+    out.clear();
+
+    if (count == 0 || maxCount == 0)
+        return;
+
+    auto end = (beforeSeq == 0 || beforeSeq > nextSeq) ? nextSeq : beforeSeq;
+    auto first = getFirstSeq();
+
+    if (end <= first)
+        return;
+
+    auto start = end - std::min<uint64_t>(maxCount, end - first);
+    out.reserve(static_cast<size_t>(end - start));
+
+    for (auto seq = start; seq < end; ++seq)
+        out.push_back(entryFor(seq));
+}
+
+uint64_t ChatHistoryStore::findFirstSeqAtOrAfter(int64_t timestamp) const
+{
+    auto lo = getFirstSeq();
+    auto hi = nextSeq;
+
+    if (count == 0)
+        return hi;
+
+    while (lo < hi) {
+        auto mid = lo + (hi - lo) / 2;
+
+        if (slotFor(mid).createdAt < timestamp)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+bool ChatHistoryStore::getMessage(uint64_t seq, Entry& out) const
+{
+    if (count == 0 || seq < getFirstSeq() || seq >= nextSeq)
+        return false;
+
+    out = entryFor(seq);
+    return true;
+}
+
+//==============================================================================
+uint32_t ChatHistoryStore::intern(std::string_view nickname)
+{
+    auto it = nicknameIds.find(nickname);
+
+    if (it != nicknameIds.end()) {
+        ++nicknames[it->second].refs;
+        return it->second;
+    }
+
+    uint32_t id = 0;
+
+    if (!freeNicknameIds.empty()) {
+        id = freeNicknameIds.back();
+        freeNicknameIds.pop_back();
+        nicknames[id].name.assign(nickname.data(), nickname.size());
+    } else {
+        id = static_cast<uint32_t>(nicknames.size());
+        nicknames.push_back({ std::string(nickname), 0 });
+    }
+
+    nicknames[id].refs = 1;
+    nicknameIds.emplace(nicknames[id].name, id);
+    return id;
+}
+
+void ChatHistoryStore::release(uint32_t nicknameId)
+{
+    auto& nickname = nicknames[nicknameId];
+
+    if (--nickname.refs > 0)
+        return;
+
+    nicknameIds.erase(nickname.name);
+    freeNicknameIds.push_back(nicknameId);
+}
+
+ChatHistoryStore::Entry ChatHistoryStore::entryFor(uint64_t seq) const
+{
+    auto const& slot = slotFor(seq);
+    return { seq, { nicknames[slot.nicknameId].name, slot.text, slot.createdAt } };
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "ChatMessage.h"
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+
+//==============================================================================
+// A bounded, in-processor store of received chat messages.
+//
+// Messages live in a fixed-capacity ring buffer and are addressed by a sequence
+// number that increases by one per message and never repeats, so the editor can
+// page backwards from any point it has seen. Since createdAt is monotonic across
+// the ring, it can be searched by timestamp as well. Nicknames are interned: each
+// slot holds a small id instead of its own copy of the sender's name. An id is
+// freed, and later reused, once the last message from that sender is evicted.
+//
+// Not thread-safe; the owner serialises access.
+class ChatHistoryStore
+{
+public:
+    //==============================================================================
+    struct Entry
+    {
+        uint64_t seq = 0;
+
+        // Views into the store; valid until the next append() or clear()
+        ChatMessage message;
+    };
+
+    //==============================================================================
+    explicit ChatHistoryStore(size_t capacity = 2048);
+
+    //==============================================================================
+    // Stores a copy of the message and returns its sequence number.
+    uint64_t append(ChatMessage const& message);
+
+    void clear();
+
+    size_t size() const { return count; }
+    size_t capacity() const { return slots.size(); }
+
+    // Sequence numbers of the oldest and newest stored message (0 when empty)
+    uint64_t getFirstSeq() const { return count > 0 ? nextSeq - count : 0; }
+    uint64_t getLastSeq() const { return count > 0 ? nextSeq - 1 : 0; }
+
+    //==============================================================================
+    // Fills `out` with up to `maxCount` messages whose seq is below `beforeSeq`,
+    // oldest first. A `beforeSeq` of 0 means "the newest messages".
+    void getMessages(uint64_t beforeSeq, size_t maxCount, std::vector<Entry>& out) const;
+
+    // Returns the seq of the oldest stored message with createdAt >= timestamp,
+    // or getLastSeq() + 1 if there is none.
+    uint64_t findFirstSeqAtOrAfter(int64_t timestamp) const;
+
+    // Looks up a single message; returns false if it has been evicted.
+    bool getMessage(uint64_t seq, Entry& out) const;
+
+    std::string_view getNickname(uint32_t nicknameId) const { return nicknames[nicknameId].name; }
+
+private:
+    //==============================================================================
+    struct Slot
+    {
+        int64_t createdAt = 0;
+        uint32_t nicknameId = 0;
+        std::string text;
+    };
+
+    struct Nickname
+    {
+        std::string name;
+
+        // The number of slots holding this id
+        uint32_t refs = 0;
+    };
+
+    uint32_t intern(std::string_view nickname);
+    void release(uint32_t nicknameId);
+    Slot const& slotFor(uint64_t seq) const { return slots[seq % slots.size()]; }
+    Entry entryFor(uint64_t seq) const;
+
+    //==============================================================================
+    std::vector<Slot> slots;
+    size_t count = 0;
+    uint64_t nextSeq = 1;
+
+    // A deque keeps the interned strings at stable addresses for the map's keys
+    std::deque<Nickname> nicknames;
+    std::vector<uint32_t> freeNicknameIds;
+    std::unordered_map<std::string_view, uint32_t> nicknameIds;
+};
@@ -0,0 +1,386 @@
+#include "ChatHttpClient.h"
+
+#include <algorithm>
+
+namespace
+{
+    constexpr size_t kReadBufferSize = 16 * 1024;
+    constexpr size_t kMaxIdlePerHost = 2;
+    constexpr int kWaitSliceMs = 50;
+
+    // Connecting is blocking, so it is tried in attempts this long to notice a
+    // cancel() in between; a handshake with the chat API takes far less
+    constexpr int kConnectSliceMs = 500;
+
+    double nowMs()
+    {
+        return juce::Time::getMillisecondCounterHiRes();
+    }
+}
+
+//==============================================================================
+struct ChatHttpClient::Connection
+{
+    juce::StreamingSocket socket;
+
+    // Bytes received but not yet consumed by the response parser
+    std::string inbox;
+};
+
+//==============================================================================
+ChatHttpClient::ChatHttpClient()
+    : readBuffer(kReadBufferSize)
+{
+}
+
+ChatHttpClient::~ChatHttpClient()
+{
+    cancel();
+}
+
+//==============================================================================
+bool ChatHttpClient::supportsUrl(std::string const& url)
+{
+    Endpoint endpoint;
+    return parseUrl(url, endpoint);
+}
+
+bool ChatHttpClient::parseUrl(std::string const& url, Endpoint& out)
+{
+    static const std::string scheme = "http://";
+
+    if (url.compare(0, scheme.size(), scheme) != 0)
+        return false;
+
+    auto hostStart = scheme.size();
+    auto pathStart = url.find('/', hostStart);
+    auto authority = url.substr(hostStart, pathStart == std::string::npos ? std::string::npos : pathStart - hostStart);
+    auto colon = authority.find(':');
+
+    out.host = authority.substr(0, colon);
+    out.port = colon == std::string::npos ? 80 : std::atoi(authority.c_str() + colon + 1);
+    out.path = pathStart == std::string::npos ? "/" : url.substr(pathStart);
+
+    return !out.host.empty() && out.port > 0;
+}
+
+//==============================================================================
+ChatHttpClient::Response ChatHttpClient::post(std::string const& url, juce::String const& jsonBody, int timeoutMs)
+{
+    Response response;
+    Endpoint endpoint;
+
+    if (!parseUrl(url, endpoint) || cancelled)
+        return response;
+
+    auto startMs = nowMs();
+
+    // A pooled connection may have been closed by the server while idle, which we
+    // only find out when using it; retry once on a fresh one in that case.
+    for (int attempt = 0; attempt < 2 && !cancelled; ++attempt)
+    {
+        response = {};
+        auto connection = acquire(endpoint, timeoutMs, response.timing);
+
+        if (connection == nullptr)
+            break;
+
+        bool keepAlive = false;
+        bool ok = sendRequest(*connection, endpoint, jsonBody)
+               && readResponse(*connection, timeoutMs, response, keepAlive, startMs);
+
+        if (ok) {
+            response.timing.totalMs = nowMs() - startMs;
+
+            if (keepAlive)
+                release(endpoint.key(), std::move(connection));
+
+            break;
+        }
+
+        // Only a reused socket that failed before answering is worth a retry
+        if (!response.timing.reusedConnection || response.statusCode != 0)
+            break;
+    }
+
+    const juce::ScopedLock sl(statsLock);
+    ++stats.requests;
+    stats.reusedConnections += response.timing.reusedConnection ? 1 : 0;
+    stats.failures += response.ok ? 0 : 1;
+    stats.bytesOnWire += response.timing.bytesOnWire;
+    stats.bytesDecoded += response.timing.bytesDecoded;
+    stats.totalConnectMs += response.timing.connectMs;
+    stats.totalFirstByteMs += response.timing.firstByteMs;
+    stats.totalMs += response.timing.totalMs;
+
+    return response;
+}
+
+void ChatHttpClient::cancel()
+{
+    cancelled = true;
+
+    const juce::ScopedLock sl(poolLock);
+    pool.clear();
+}
+
+ChatHttpClient::Stats ChatHttpClient::getStats() const
+{
+    const juce::ScopedLock sl(statsLock);
+    return stats;
+}
+
+//==============================================================================
+std::unique_ptr<ChatHttpClient::Connection> ChatHttpClient::acquire(Endpoint const& endpoint, int timeoutMs, Timing& timing)
+{
+    {
+        const juce::ScopedLock sl(poolLock);
+        auto& idle = pool[endpoint.key()];
+
+        while (!idle.empty()) {
+            auto connection = std::move(idle.back());
+            idle.pop_back();
+
+            // An idle keep-alive socket that is readable has either been closed by
+            // the server or has stray data on it; neither is safe to reuse.
+            if (connection->socket.isConnected() && connection->socket.waitUntilReady(true, 0) == 0) {
+                timing.reusedConnection = true;
+                return connection;
+            }
+        }
+    }
+
+    auto connectStart = nowMs();
+    auto deadline = connectStart + timeoutMs;
+
+    while (!cancelled) {
+        auto attemptStart = nowMs();
+        auto sliceMs = std::min(kConnectSliceMs, static_cast<int>(deadline - attemptStart));
+
+        if (sliceMs <= 0)
+            break;
+
+        auto connection = std::make_unique<Connection>();
+
+        if (connection->socket.connect(endpoint.host, endpoint.port, sliceMs)) {
+            timing.connectMs = nowMs() - connectStart;
+            return connection;
+        }
+
+        // An attempt that gave up before its slice was up was refused, or the
+        // host did not resolve, rather than slow; another try will not help
+        if (nowMs() - attemptStart < sliceMs - kWaitSliceMs)
+            break;
+    }
+
+    DBG("ChatHttpClient failed to connect to " << juce::String(endpoint.host) << ":" << endpoint.port);
+    return nullptr;
+}
+
+void ChatHttpClient::release(std::string const& key, std::unique_ptr<Connection> connection)
+{
+    if (cancelled || !connection->inbox.empty())
+        return;
+
+    const juce::ScopedLock sl(poolLock);
+    auto& idle = pool[key];
+
+    if (idle.size() < kMaxIdlePerHost)
+        idle.push_back(std::move(connection));
+}
+
+//==============================================================================
+bool ChatHttpClient::sendRequest(Connection& connection, Endpoint const& endpoint, juce::String const& body)
+{
+    auto numBodyBytes = body.getNumBytesAsUTF8();
+
+    juce::MemoryOutputStream request(512 + numBodyBytes);
+    request << "POST " << juce::String(endpoint.path) << " HTTP/1.1\r\n"
+            << "Host: " << juce::String(endpoint.host) << (endpoint.port != 80 ? ":" + juce::String(endpoint.port) : juce::String()) << "\r\n"
+            << "Connection: keep-alive\r\n"
+            << "Accept-Encoding: gzip, deflate\r\n"
+            << "Content-Type: application/json\r\n"
+            << "Content-Length: " << (int) numBodyBytes << "\r\n\r\n";
+    request.write(body.toRawUTF8(), numBodyBytes);
+
+    connection.inbox.clear();
+
+    auto numBytes = static_cast<int>(request.getDataSize());
+    return connection.socket.write(request.getData(), numBytes) == numBytes;
+}
+
+bool ChatHttpClient::readSome(Connection& connection, int timeoutMs)
+{
+    auto deadline = nowMs() + timeoutMs;
+
+    // Wait in short slices so cancel() takes effect promptly
+    while (!cancelled) {
+        auto ready = connection.socket.waitUntilReady(true, kWaitSliceMs);
+
+        if (ready < 0)
+            return false;
+
+        if (ready > 0) {
+            auto numRead = connection.socket.read(readBuffer.data(), static_cast<int>(readBuffer.size()), false);
+
+            if (numRead <= 0)
+                return false;
+
+            connection.inbox.append(readBuffer.data(), static_cast<size_t>(numRead));
+            return true;
+        }
+
+        if (nowMs() > deadline)
+            return false;
+    }
+
+    return false;
+}
+
+bool ChatHttpClient::readResponse(Connection& connection, int timeoutMs, Response& response, bool& keepAlive, double startMs)
+{
+    auto& inbox = connection.inbox;
+    size_t headerEnd = std::string::npos;
+
+    while ((headerEnd = inbox.find("\r\n\r\n")) == std::string::npos) {
+        if (!readSome(connection, timeoutMs))
+            return false;
+
+        if (response.timing.firstByteMs == 0.0)
+            response.timing.firstByteMs = nowMs() - startMs;
+    }
+
+    // Status line and headers
+    auto headerLines = juce::StringArray::fromLines(juce::String::fromUTF8(inbox.data(), static_cast<int>(headerEnd)));
+
+    if (headerLines.isEmpty())
+        return false;
+
+    auto statusLine = headerLines[0];
+    auto isHttp11 = statusLine.startsWith("HTTP/1.1");
+    response.statusCode = statusLine.fromFirstOccurrenceOf(" ", false, false).getIntValue();
+
+    juce::String contentEncoding, transferEncoding, connectionHeader;
+    int64_t contentLength = -1;
+
+    for (int i = 1; i < headerLines.size(); ++i) {
+        auto name = headerLines[i].upToFirstOccurrenceOf(":", false, false).trim().toLowerCase();
+        auto value = headerLines[i].fromFirstOccurrenceOf(":", false, false).trim();
+
+        if (name == "content-length")         contentLength = value.getLargeIntValue();
+        else if (name == "content-encoding")  contentEncoding = value.toLowerCase();
+        else if (name == "transfer-encoding") transferEncoding = value.toLowerCase();
+        else if (name == "connection")        connectionHeader = value.toLowerCase();
+    }
+
+    keepAlive = isHttp11 ? connectionHeader != "close" : connectionHeader == "keep-alive";
+
+    // Body
+    rawBody.reset();
+    size_t pos = headerEnd + 4;
+
+    if (transferEncoding.contains("chunked")) {
+        for (;;) {
+            size_t lineEnd;
+
+            while ((lineEnd = inbox.find("\r\n", pos)) == std::string::npos)
+                if (!readSome(connection, timeoutMs))
+                    return false;
+
+            auto chunkSize = static_cast<size_t>(std::strtoull(inbox.c_str() + pos, nullptr, 16));
+            pos = lineEnd + 2;
+
+            while (inbox.size() < pos + chunkSize + 2)
+                if (!readSome(connection, timeoutMs))
+                    return false;
+
+            if (chunkSize == 0) {
+                // Skip any trailers up to the terminating blank line
+                size_t end = 0;
+
+                for (;;) {
+                    if (inbox.compare(pos, 2, "\r\n") == 0) {
+                        end = pos + 2;
+                        break;
+                    }
+
+                    auto trailersEnd = inbox.find("\r\n\r\n", pos);
+
+                    if (trailersEnd != std::string::npos) {
+                        end = trailersEnd + 4;
+                        break;
+                    }
+
+                    if (!readSome(connection, timeoutMs))
+                        return false;
+                }
+
+                inbox.erase(0, end);
+                break;
+            }
+
+            rawBody.append(inbox.data() + pos, chunkSize);
+            pos += chunkSize + 2;
+        }
+    } else if (contentLength >= 0) {
+        while (inbox.size() < pos + static_cast<size_t>(contentLength))
+            if (!readSome(connection, timeoutMs))
+                return false;
+
+        rawBody.append(inbox.data() + pos, static_cast<size_t>(contentLength));
+        inbox.erase(0, pos + static_cast<size_t>(contentLength));
+    } else {
+        // No framing: the body runs until the server closes the connection
+        keepAlive = false;
+
+        while (readSome(connection, timeoutMs)) {}
+
+        rawBody.append(inbox.data() + pos, inbox.size() - pos);
+        inbox.clear();
+    }
+
+    response.timing.bytesOnWire = rawBody.getSize();
+
+    if (!decodeBody(contentEncoding, response))
+        return false;
+
+    response.ok = response.statusCode >= 200 && response.statusCode < 300;
+    return true;
+}
+
+bool ChatHttpClient::decodeBody(juce::String const& contentEncoding, Response& response)
+{
+    if (contentEncoding.isEmpty() || contentEncoding == "identity") {
+        response.body = juce::String::fromUTF8(static_cast<const char*>(rawBody.getData()), static_cast<int>(rawBody.getSize()));
+        response.timing.bytesDecoded = rawBody.getSize();
+        return true;
+    }
+
+    auto inflate = [this](juce::GZIPDecompressorInputStream::Format format) {
+        juce::MemoryInputStream source(rawBody, false);
+        juce::GZIPDecompressorInputStream decompressor(&source, false, format);
+
+        decodedBody.reset();
+        decodedBody.writeFromInputStream(decompressor, -1);
+        return decodedBody.getDataSize() > 0;
+    };
+
+    bool ok = false;
+
+    if (contentEncoding == "gzip" || contentEncoding == "x-gzip") {
+        ok = inflate(juce::GZIPDecompressorInputStream::gzipFormat);
+    } else if (contentEncoding == "deflate") {
+        // "deflate" is meant to be zlib-wrapped, but some servers send it raw
+        ok = inflate(juce::GZIPDecompressorInputStream::zlibFormat)
+          || inflate(juce::GZIPDecompressorInputStream::deflateFormat);
+    } else {
+        DBG("ChatHttpClient: unsupported Content-Encoding " << contentEncoding);
+    }
+
+    if (!ok && rawBody.getSize() > 0)
+        return false;
+
+    response.body = juce::String::fromUTF8(static_cast<const char*>(decodedBody.getData()), static_cast<int>(decodedBody.getDataSize()));
+    response.timing.bytesDecoded = decodedBody.getDataSize();
+    return true;
+}
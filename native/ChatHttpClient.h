@@ -0,0 +1,115 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+//==============================================================================
+// A small HTTP/1.1 client for the chat API that keeps connections alive between
+// requests.
+//
+// Idle sockets are pooled per host and reused, so a busy session pays TCP setup
+// once rather than on every poll or send. Responses advertise gzip/deflate support
+// and are decoded transparently; bodies are read into buffers that live as long
+// as the client. Only plain http is handled here; callers fall back to
+// juce::WebInputStream for anything else (see supportsUrl()).
+//
+// A client is meant to be driven by a single thread at a time; cancel() and the
+// stats accessors may be called from any thread.
+class ChatHttpClient
+{
+public:
+    //==============================================================================
+    struct Timing
+    {
+        double connectMs = 0.0;     // zero when a pooled connection was reused
+        double firstByteMs = 0.0;
+        double totalMs = 0.0;
+        bool reusedConnection = false;
+        size_t bytesOnWire = 0;     // response bytes as received, before decoding
+        size_t bytesDecoded = 0;
+    };
+
+    struct Response
+    {
+        bool ok = false;
+        int statusCode = 0;
+        juce::String body;
+        Timing timing;
+    };
+
+    struct Stats
+    {
+        uint64_t requests = 0;
+        uint64_t reusedConnections = 0;
+        uint64_t failures = 0;
+        uint64_t bytesOnWire = 0;
+        uint64_t bytesDecoded = 0;
+        double totalConnectMs = 0.0;
+        double totalFirstByteMs = 0.0;
+        double totalMs = 0.0;
+    };
+
+    //==============================================================================
+    ChatHttpClient();
+    ~ChatHttpClient();
+
+    //==============================================================================
+    static bool supportsUrl(std::string const& url);
+
+    Response post(std::string const& url, juce::String const& jsonBody, int timeoutMs = 10000);
+
+    // Aborts the request in flight, if any, and drops all pooled connections.
+    // The aborted request returns within one socket wait or connect slice.
+    // Requests fail straight away from then on, until resume() is called.
+    void cancel();
+
+    // Lets requests run again after cancel(). Called by the thread driving the
+    // client, for a request it knows was made after the cancel.
+    void resume() { cancelled = false; }
+
+    Stats getStats() const;
+
+private:
+    //==============================================================================
+    struct Endpoint
+    {
+        std::string host;
+        int port = 80;
+        std::string path;
+
+        std::string key() const { return host + ":" + std::to_string(port); }
+    };
+
+    struct Connection;
+
+    static bool parseUrl(std::string const& url, Endpoint& out);
+
+    std::unique_ptr<Connection> acquire(Endpoint const& endpoint, int timeoutMs, Timing& timing);
+    void release(std::string const& key, std::unique_ptr<Connection> connection);
+
+    bool sendRequest(Connection& connection, Endpoint const& endpoint, juce::String const& body);
+    bool readResponse(Connection& connection, int timeoutMs, Response& response, bool& keepAlive, double startMs);
+    bool readSome(Connection& connection, int timeoutMs);
+    bool decodeBody(juce::String const& contentEncoding, Response& response);
+
+    //==============================================================================
+    juce::CriticalSection poolLock;
+    std::map<std::string, std::vector<std::unique_ptr<Connection>>> pool;
+    std::atomic<bool> cancelled { false };
+
+    // Reused across requests so steady-state reads do not allocate
+    std::vector<char> readBuffer;
+    juce::MemoryBlock rawBody;
+    juce::MemoryOutputStream decodedBody;
+
+    mutable juce::CriticalSection statsLock;
+    Stats stats;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ChatHttpClient)
+};
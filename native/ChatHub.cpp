@@ -0,0 +1,382 @@
+#include "ChatHub.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace
+{
+    constexpr int kPollIntervalMs = 10000;
+
+    // What tells two messages with the same createdAt apart
+    uint64_t identityOf(ChatMessage const& message)
+    {
+        auto const nickname = static_cast<uint64_t>(std::hash<std::string_view>{}(message.nickname));
+        auto const text = static_cast<uint64_t>(std::hash<std::string_view>{}(message.text));
+        return nickname * 0x9e3779b97f4a7c15ull ^ text;
+    }
+}
+
+//==============================================================================
+ChatHub::ChatHub()
+    : outbox([this](ChatOutbox::PendingMessage const& message, bool startsSequence, ChatOutbox::Done done) {
+                 postToServer(message, startsSequence, std::move(done));
+             },
+             [this] {
+                 fetchNewMessages();
+             })
+{
+    auto apiOverride = juce::SystemStats::getEnvironmentVariable("ELEM_CHAT_API_URL", {});
+
+    if (apiOverride.isNotEmpty())
+        setApiBaseUrl(apiOverride.toStdString());
+}
+
+ChatHub::~ChatHub()
+{
+    stopReceiving();
+    network.cancelPending();
+}
+
+//==============================================================================
+void ChatHub::addListener(Listener* listener)
+{
+    listeners.add(listener);
+
+    if (listeners.size() == 1)
+        startReceiving();
+}
+
+void ChatHub::removeListener(Listener* listener)
+{
+    listeners.remove(listener);
+
+    if (listeners.isEmpty())
+        stopReceiving();
+}
+
+void ChatHub::setApiBaseUrl(std::string const& baseUrl)
+{
+    apiBaseUrl = baseUrl;
+    apiSendEndpoint = apiBaseUrl + "/messages/send";
+    apiGetEndpoint = apiBaseUrl + "/messages/get";
+    apiStreamEndpoint = apiBaseUrl + "/messages/stream";
+}
+
+//==============================================================================
+// Receive transport control
+//
+// Polling runs whenever the stream is disabled or down; while the stream is
+// connected it delivers messages as they are posted and the poll timer is idle.
+void ChatHub::setStreamingEnabled(bool shouldStream)
+{
+    if (streamingEnabled == shouldStream)
+        return;
+
+    streamingEnabled = shouldStream;
+
+    if (isTimerRunning() || streamReceiver != nullptr) {
+        stopReceiving();
+        startReceiving();
+    }
+}
+
+void ChatHub::startReceiving()
+{
+    startTimer(kPollIntervalMs);  // Poll until the stream is up
+
+    if (streamingEnabled && streamReceiver == nullptr) {
+        ChatStreamReceiver::Callbacks callbacks;
+
+        callbacks.getCursor = [this]() {
+            return cursor.load();
+        };
+
+        callbacks.onEvent = [this](juce::String const& payload) {
+            handleMessagesResponse(payload);
+        };
+
+        callbacks.onConnectionChanged = [this](bool connected) {
+            if (connected) {
+                stopTimer();
+            } else if (streamReceiver != nullptr) {
+                startTimer(kPollIntervalMs);
+            }
+        };
+
+        streamReceiver = std::make_unique<ChatStreamReceiver>(apiStreamEndpoint, std::move(callbacks));
+        streamReceiver->start();
+    }
+}
+
+void ChatHub::stopReceiving()
+{
+    stopTimer();
+    streamReceiver.reset();
+}
+
+void ChatHub::timerCallback()
+{
+    fetchNewMessages();  // Only queues the request; never blocks the message thread
+}
+
+//==============================================================================
+// Message sending and fetching
+//
+// Both requests run on the ChatNetworkWorker thread, and their completions come
+// back to the message thread. Only fetches move the cursor: a send's response
+// may hold the sent message without the ones posted just before it, so a
+// confirmed send triggers a fetch instead, which returns everything in order.
+void ChatHub::fetchNewMessages()
+{
+    if (fetchHolds > 0) {
+        fetchDeferred = true;
+        ++stats.fetchesDeferred;
+        return;
+    }
+
+    // Skip this tick if the previous poll is still waiting on a slow server
+    // rather than piling up requests behind it. A fetch asked for in the
+    // meantime runs as soon as it completes.
+    if (fetchInFlight) {
+        fetchAgain = true;
+        return;
+    }
+
+    fetchAgain = false;
+
+    try {
+        auto postData = std::make_unique<juce::DynamicObject>();
+        postData->setProperty("fromTimestamp", cursor.load());
+
+        juce::var jsonVar(postData.release());
+        juce::String jsonString = juce::JSON::toString(jsonVar);
+
+        fetchInFlight = true;
+        ++stats.fetches;
+        Trace::instant("net", "chat.fetch");
+
+        network.post(apiGetEndpoint, jsonString, [this](ChatNetworkWorker::Response const& response) {
+            fetchInFlight = false;
+
+            if (response.ok)
+                handleMessagesResponse(response.body);
+            else
+                DBG("fetchNewMessages failed with status " << response.statusCode);
+
+            if (fetchAgain)
+                fetchNewMessages();
+        });
+    } catch (const std::exception& e) {
+        fetchInFlight = false;
+        DBG("Exception in fetchNewMessages: " << e.what());
+    } catch (...) {
+        fetchInFlight = false;
+        DBG("Unknown exception in fetchNewMessages");
+    }
+}
+
+void ChatHub::sendMessage(std::string const& nickname, std::string const& message)
+{
+    outbox.enqueue(nickname, message);
+}
+
+void ChatHub::postToServer(ChatOutbox::PendingMessage const& message, bool startsSequence, ChatOutbox::Done done)
+{
+    if (startsSequence || sendSequence == nullptr)
+        sendSequence = std::make_shared<ChatNetworkWorker::Sequence>();
+
+    try {
+        auto postData = std::make_unique<juce::DynamicObject>();
+        postData->setProperty("nickname", juce::String(message.nickname));
+        postData->setProperty("message", juce::String(message.text));
+
+        // Lets the server drop a resend of a message it already has
+        postData->setProperty("clientId", juce::String(message.id));
+
+        juce::var jsonVar(postData.release());
+        juce::String jsonString = juce::JSON::toString(jsonVar);
+
+        network.post(apiSendEndpoint, jsonString, [done](ChatNetworkWorker::Response const& response) {
+            if (response.skipped) {
+                done(ChatOutbox::Result::skipped);
+                return;
+            }
+
+            if (!response.ok)
+                DBG("sendMessage failed with status " << response.statusCode);
+
+            done(ChatOutbox::resultForStatus(response.statusCode));
+        }, sendSequence);
+    } catch (const std::exception& e) {
+        DBG("Exception in sendMessage: " << e.what());
+        sendSequence->failed = true;
+        juce::MessageManager::callAsync([done] { done(ChatOutbox::Result::retry); });
+    } catch (...) {
+        DBG("Unknown exception in sendMessage");
+        sendSequence->failed = true;
+        juce::MessageManager::callAsync([done] { done(ChatOutbox::Result::retry); });
+    }
+}
+
+void ChatHub::sendAudioSnippet(std::string const& nickname, juce::MemoryBlock const& flac, double seconds)
+{
+    try {
+        auto postData = std::make_unique<juce::DynamicObject>();
+        postData->setProperty("nickname", juce::String(nickname));
+        postData->setProperty("message", "shared " + juce::String(seconds, 1) + " s of audio");
+        postData->setProperty("audio", flac.toBase64Encoding());
+        postData->setProperty("audioFormat", "audio/flac");
+        postData->setProperty("clientId", juce::Uuid().toString());
+
+        juce::var jsonVar(postData.release());
+        juce::String jsonString = juce::JSON::toString(jsonVar);
+
+        network.post(apiSendEndpoint, jsonString, [this](ChatNetworkWorker::Response const& response) {
+            if (!response.ok) {
+                DBG("sendAudioSnippet failed with status " << response.statusCode);
+                return;
+            }
+
+            fetchNewMessages();
+        });
+    } catch (const std::exception& e) {
+        DBG("Exception in sendAudioSnippet: " << e.what());
+    } catch (...) {
+        DBG("Unknown exception in sendAudioSnippet");
+    }
+}
+
+void ChatHub::handleMessagesResponse(juce::String const& body)
+{
+    ELEM_TRACE_SPAN("json", "chat.handleMessagesResponse");
+
+    try {
+        ++stats.responses;
+        responseArena.reset();
+        decodedMessages.clear();
+
+        auto json = std::string_view(body.toRawUTF8(), body.getNumBytesAsUTF8());
+
+        if (!ChatMessageDecoder::decodeResponse(json, responseArena, decodedMessages)) {
+            DBG("Malformed messages response");
+        }
+
+        // Polls, send responses and the stream can overlap around a transport
+        // switch, so only messages past the cursor are new. Timestamps are only
+        // milliseconds, though, so one already seen at the cursor's own
+        // timestamp is told apart from a new one by its sender and text.
+        size_t numNew = 0;
+
+        for (auto const& message : decodedMessages) {
+            if (message.createdAt < cursor.load())
+                continue;
+
+            auto const identity = identityOf(message);
+
+            if (message.createdAt == cursor.load()) {
+                if (std::find(seenAtCursor.begin(), seenAtCursor.end(), identity) != seenAtCursor.end())
+                    continue;
+            } else {
+                cursor = message.createdAt;
+                seenAtCursor.clear();
+            }
+
+            seenAtCursor.push_back(identity);
+            decodedMessages[numNew++] = message;
+        }
+
+        publish(decodedMessages.data(), numNew);
+    } catch (const std::exception& e) {
+        DBG("Exception in handleMessagesResponse: " << e.what());
+    } catch (...) {
+        DBG("Unknown exception in handleMessagesResponse");
+    }
+}
+
+void ChatHub::addLocalMessage(ChatMessage const& message)
+{
+    publish(&message, 1);
+}
+
+// Stores the messages and hands them to every listener as one shared batch.
+// Listeners without an editor simply drop it; the history has it.
+void ChatHub::publish(ChatMessage const* messages, size_t numMessages)
+{
+    if (numMessages == 0)
+        return;
+
+    auto batch = std::make_shared<Batch>(numMessages);
+
+    {
+        const juce::ScopedLock sl(historyLock);
+
+        for (size_t i = 0; i < numMessages; ++i)
+            (*batch)[i].seq = appendToHistory(messages[i]);
+    }
+
+    for (size_t i = 0; i < numMessages; ++i) {
+        auto& entry = (*batch)[i];
+        entry.json.reserve(messages[i].nickname.size() + messages[i].text.size() + 96);
+        appendChatMessageJson(entry.json, messages[i], entry.seq);
+    }
+
+    stats.messagesReceived += numMessages;
+    ++stats.batchesPublished;
+
+    std::shared_ptr<const Batch> published = std::move(batch);
+    listeners.call([&](Listener& l) { l.chatMessagesReceived(published); });
+}
+
+void ChatHub::holdFetches()
+{
+    ++fetchHolds;
+}
+
+void ChatHub::releaseFetches()
+{
+    jassert(fetchHolds > 0);
+
+    if (--fetchHolds == 0 && fetchDeferred) {
+        fetchDeferred = false;
+        fetchNewMessages();
+    }
+}
+
+//==============================================================================
+void ChatHub::restore(int64_t savedCursor, std::vector<StoredChatMessage> const& savedHistory)
+{
+    // The first fetch after a reload only asks for what arrived since the save
+    if (savedCursor > cursor.load()) {
+        cursor = savedCursor;
+        seenAtCursor.clear();
+
+        for (auto const& message : savedHistory)
+            if (message.createdAt == savedCursor)
+                seenAtCursor.push_back(identityOf(message.view()));
+    }
+
+    const juce::ScopedLock sl(historyLock);
+
+    if (history.size() > 0)
+        return;
+
+    for (auto const& message : savedHistory)
+        appendToHistory(message.view());
+}
+
+// Called with historyLock held
+uint64_t ChatHub::appendToHistory(ChatMessage const& message)
+{
+    auto const seq = history.append(message);
+    searchIndex.add(seq, message);
+    searchIndex.removeBefore(history.getFirstSeq());
+    return seq;
+}
+
+ChatHub::Stats ChatHub::getStats() const
+{
+    auto result = stats;
+    result.listeners = listeners.size();
+    return result;
+}
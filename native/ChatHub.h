@@ -0,0 +1,177 @@
+#pragma once
+
+#include <juce_events/juce_events.h>
+
+#include "ChatHistoryStore.h"
+#include "ChatMessage.h"
+#include "ChatNetworkWorker.h"
+#include "ChatOutbox.h"
+#include "ChatSearchIndex.h"
+#include "ChatStreamReceiver.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+//==============================================================================
+// The chat connection shared by every plugin instance in the process.
+//
+// Held through juce::SharedResourcePointer<ChatHub>, so the first instance
+// creates it and the last one to go destroys it. It owns the network worker,
+// the stream, the poll timer, the receive cursor and the message history. Each
+// response is therefore fetched, decoded and serialised once, however many
+// instances are loaded. New messages are published to listeners as an immutable,
+// shared batch of already-serialised entries.
+//
+// Polling runs while at least one listener is subscribed and the stream is
+// disabled or down. Everything here is message thread only, except for
+// withHistory() and withSearchIndex(), which may be called from any thread.
+class ChatHub : private juce::Timer
+{
+public:
+    //==============================================================================
+    struct Entry
+    {
+        uint64_t seq = 0;
+
+        // The message's WebView representation, see appendChatMessageJson()
+        std::string json;
+    };
+
+    using Batch = std::vector<Entry>;
+
+    class Listener
+    {
+    public:
+        virtual ~Listener() = default;
+
+        // Called on the message thread with messages past the cursor, oldest first.
+        virtual void chatMessagesReceived(std::shared_ptr<const Batch> const& batch) = 0;
+    };
+
+    struct Stats
+    {
+        uint64_t fetches = 0;
+        uint64_t fetchesDeferred = 0;
+        uint64_t responses = 0;
+        uint64_t messagesReceived = 0;
+        uint64_t batchesPublished = 0;
+        int listeners = 0;
+    };
+
+    //==============================================================================
+    ChatHub();
+    ~ChatHub() override;
+
+    //==============================================================================
+    // The first listener starts receiving and the last one stops it.
+    void addListener(Listener* listener);
+    void removeListener(Listener* listener);
+
+    void setApiBaseUrl(std::string const& baseUrl);
+    void setStreamingEnabled(bool shouldStream);
+
+    //==============================================================================
+    void fetchNewMessages();
+
+    // While any instance holds them, polls and fetches are put off, e.g. during
+    // an offline render; the last release runs one if any was put off.
+    void holdFetches();
+    void releaseFetches();
+
+    // Queues the message in the outbox and returns immediately.
+    void sendMessage(std::string const& nickname, std::string const& message);
+
+    // Posts an encoded audio snippet with a short text message. Snippets go
+    // straight to the server rather than through the outbox, which is saved
+    // with every project and is no place for megabytes of audio.
+    void sendAudioSnippet(std::string const& nickname, juce::MemoryBlock const& flac, double seconds);
+
+    // Stores and publishes a message that did not come from the server.
+    void addLocalMessage(ChatMessage const& message);
+
+    //==============================================================================
+    // The createdAt of the newest message received; any thread.
+    int64_t getCursor() const { return cursor.load(); }
+
+    // Restores a saved cursor and history. The history is only taken while the
+    // hub has none, since a live one is at least as new as any saved copy.
+    void restore(int64_t savedCursor, std::vector<StoredChatMessage> const& savedHistory);
+
+    ChatOutbox& getOutbox() { return outbox; }
+
+    // Runs fn with the history locked. Views handed out by the store are valid
+    // only inside fn.
+    template <typename Fn>
+    void withHistory(Fn&& fn) const
+    {
+        const juce::ScopedLock sl(historyLock);
+        fn(history);
+    }
+
+    // Runs fn(index, history) with both locked. Seqs found in the index can be
+    // looked up in the history inside fn.
+    template <typename Fn>
+    void withSearchIndex(Fn&& fn) const
+    {
+        const juce::ScopedLock sl(historyLock);
+        fn(searchIndex, history);
+    }
+
+    Stats getStats() const;
+
+    // Long-running sessions are searched back this far
+    static constexpr size_t kHistoryCapacity = 100000;
+
+private:
+    //==============================================================================
+    void timerCallback() override;
+    void startReceiving();
+    void stopReceiving();
+    void handleMessagesResponse(juce::String const& body);
+    void postToServer(ChatOutbox::PendingMessage const& message, bool startsSequence, ChatOutbox::Done done);
+    void publish(ChatMessage const* messages, size_t numMessages);
+    uint64_t appendToHistory(ChatMessage const& message);
+
+    //==============================================================================
+    juce::ListenerList<Listener> listeners;
+
+    std::string apiBaseUrl = "http://ableton-chat-01-72c15f63599a.herokuapp.com";
+    std::string apiSendEndpoint = apiBaseUrl + "/messages/send";
+    std::string apiGetEndpoint = apiBaseUrl + "/messages/get";
+    std::string apiStreamEndpoint = apiBaseUrl + "/messages/stream";
+
+    // Read by the stream receiver thread when it (re)connects
+    std::atomic<int64_t> cursor { 0 };
+
+    // Identities of the messages received at exactly the cursor's timestamp
+    std::vector<uint64_t> seenAtCursor;
+    bool fetchInFlight = false;
+    bool fetchAgain = false;
+    int fetchHolds = 0;
+    bool fetchDeferred = false;
+    bool streamingEnabled = ELEM_CHAT_STREAMING;
+
+    // Reused for every response so steady-state decoding does not allocate
+    ChatMessageArena responseArena;
+    std::vector<ChatMessage> decodedMessages;
+
+    // Bounded; pages of it are handed to editors and saved with each project.
+    // The search index covers exactly what the history holds.
+    juce::CriticalSection historyLock;
+    ChatHistoryStore history { kHistoryCapacity };
+    ChatSearchIndex searchIndex;
+
+    ChatOutbox outbox;
+    std::shared_ptr<ChatNetworkWorker::Sequence> sendSequence;
+    Stats stats;
+
+    // Declared last so they are destroyed first, cancelling any request that
+    // still holds a callback into the hub.
+    ChatNetworkWorker network;
+    std::unique_ptr<ChatStreamReceiver> streamReceiver;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ChatHub)
+};
@@ -0,0 +1,554 @@
+#include "ChatMessage.h"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+    uint64_t nanosSince(std::chrono::steady_clock::time_point start)
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+    }
+
+    //==============================================================================
+    // A cursor over the input buffer. Every method advances `p` and returns false
+    // on malformed input; nothing is ever re-read.
+    struct Parser
+    {
+        const char* p;
+        const char* end;
+        ChatMessageArena& arena;
+
+        void skipWhitespace()
+        {
+            while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t'))
+                ++p;
+        }
+
+        bool expect(char c)
+        {
+            skipWhitespace();
+
+            if (p >= end || *p != c)
+                return false;
+
+            ++p;
+            return true;
+        }
+
+        bool peek(char c)
+        {
+            skipWhitespace();
+            return p < end && *p == c;
+        }
+
+        static void appendUtf8(char*& out, uint32_t cp)
+        {
+            if (cp < 0x80) {
+                *out++ = static_cast<char>(cp);
+            } else if (cp < 0x800) {
+                *out++ = static_cast<char>(0xc0 | (cp >> 6));
+                *out++ = static_cast<char>(0x80 | (cp & 0x3f));
+            } else if (cp < 0x10000) {
+                *out++ = static_cast<char>(0xe0 | (cp >> 12));
+                *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+                *out++ = static_cast<char>(0x80 | (cp & 0x3f));
+            } else {
+                *out++ = static_cast<char>(0xf0 | (cp >> 18));
+                *out++ = static_cast<char>(0x80 | ((cp >> 12) & 0x3f));
+                *out++ = static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+                *out++ = static_cast<char>(0x80 | (cp & 0x3f));
+            }
+        }
+
+        bool readHex4(uint32_t& value)
+        {
+            if (end - p < 4)
+                return false;
+
+            value = 0;
+
+            for (int i = 0; i < 4; ++i) {
+                auto c = *p++;
+                value <<= 4;
+
+                if (c >= '0' && c <= '9')      value |= static_cast<uint32_t>(c - '0');
+                else if (c >= 'a' && c <= 'f') value |= static_cast<uint32_t>(c - 'a' + 10);
+                else if (c >= 'A' && c <= 'F') value |= static_cast<uint32_t>(c - 'A' + 10);
+                else return false;
+            }
+
+            return true;
+        }
+
+        // Scans a string literal. When `store` is set the unescaped contents are
+        // copied into the arena, otherwise the literal is only skipped. The raw
+        // view (still escaped) is always returned so keys can be compared cheaply.
+        bool readString(std::string_view& raw, std::string_view* store)
+        {
+            if (!expect('"'))
+                return false;
+
+            auto* start = p;
+            bool hasEscapes = false;
+
+            while (p < end && *p != '"') {
+                if (*p == '\\') {
+                    hasEscapes = true;
+                    ++p;
+                }
+
+                ++p;
+            }
+
+            if (p >= end)
+                return false;
+
+            raw = std::string_view(start, static_cast<size_t>(p - start));
+            ++p;
+
+            if (store == nullptr)
+                return true;
+
+            // Unescaping never grows the string, so the raw length is an upper bound
+            auto* out = arena.allocate(raw.size());
+            auto* dest = out;
+
+            if (!hasEscapes) {
+                std::memcpy(dest, raw.data(), raw.size());
+                *store = std::string_view(out, raw.size());
+                return true;
+            }
+
+            auto* saved = p;
+            p = raw.data();
+            auto* rawEnd = raw.data() + raw.size();
+
+            while (p < rawEnd) {
+                if (*p != '\\') {
+                    *dest++ = *p++;
+                    continue;
+                }
+
+                ++p;
+
+                switch (*p++) {
+                    case '"':  *dest++ = '"'; break;
+                    case '\\': *dest++ = '\\'; break;
+                    case '/':  *dest++ = '/'; break;
+                    case 'b':  *dest++ = '\b'; break;
+                    case 'f':  *dest++ = '\f'; break;
+                    case 'n':  *dest++ = '\n'; break;
+                    case 'r':  *dest++ = '\r'; break;
+                    case 't':  *dest++ = '\t'; break;
+                    case 'u': {
+                        uint32_t cp = 0;
+
+                        if (!readHex4(cp))
+                            return false;
+
+                        // A surrogate without its other half has no UTF-8 form,
+                        // so it becomes U+FFFD, as a browser would decode it
+                        if (cp >= 0xd800 && cp < 0xdc00) {
+                            auto* next = p;
+                            uint32_t low = 0;
+
+                            if (rawEnd - p >= 6 && p[0] == '\\' && p[1] == 'u') {
+                                p += 2;
+
+                                if (!readHex4(low))
+                                    return false;
+                            }
+
+                            if (low >= 0xdc00 && low <= 0xdfff) {
+                                cp = 0x10000 + ((cp - 0xd800) << 10) + (low - 0xdc00);
+                            } else {
+                                cp = 0xfffd;
+                                p = next;  // The next escape is decoded on its own
+                            }
+                        } else if (cp >= 0xdc00 && cp <= 0xdfff) {
+                            cp = 0xfffd;
+                        }
+
+                        appendUtf8(dest, cp);
+                        break;
+                    }
+                    default:
+                        return false;
+                }
+            }
+
+            p = saved;
+            *store = std::string_view(out, static_cast<size_t>(dest - out));
+            return true;
+        }
+
+        bool readNumber(int64_t& value)
+        {
+            skipWhitespace();
+            auto* start = p;
+            bool negative = false;
+            bool integral = true;
+            int64_t acc = 0;
+
+            if (p < end && *p == '-') {
+                negative = true;
+                ++p;
+            }
+
+            if (p == end || *p < '0' || *p > '9')
+                return false;
+
+            // Past int64 it is not a timestamp; failing the batch beats wrapping
+            while (p < end && *p >= '0' && *p <= '9') {
+                auto const digit = static_cast<int64_t>(*p++ - '0');
+
+                if (acc > (std::numeric_limits<int64_t>::max() - digit) / 10)
+                    return false;
+
+                acc = acc * 10 + digit;
+            }
+
+            while (p < end && (*p == '.' || *p == 'e' || *p == 'E' || *p == '+' || *p == '-' || (*p >= '0' && *p <= '9'))) {
+                integral = false;
+                ++p;
+            }
+
+            if (integral) {
+                value = negative ? -acc : acc;
+            } else {
+                // Rare: a fractional or exponent timestamp. Fall back to strtod.
+                std::string copy(start, static_cast<size_t>(p - start));
+                auto const parsed = std::strtod(copy.c_str(), nullptr);
+
+                if (!(std::abs(parsed) < 9.2e18))
+                    return false;
+
+                value = static_cast<int64_t>(parsed);
+            }
+
+            return true;
+        }
+
+        bool skipLiteral(const char* literal)
+        {
+            auto len = std::strlen(literal);
+
+            if (static_cast<size_t>(end - p) < len || std::memcmp(p, literal, len) != 0)
+                return false;
+
+            p += len;
+            return true;
+        }
+
+        bool skipValue(int depth = 0)
+        {
+            if (depth > 64)
+                return false;
+
+            skipWhitespace();
+
+            if (p >= end)
+                return false;
+
+            switch (*p) {
+                case '"': {
+                    std::string_view raw;
+                    return readString(raw, nullptr);
+                }
+                case '{': {
+                    ++p;
+
+                    if (peek('}'))
+                        return expect('}');
+
+                    do {
+                        std::string_view key;
+
+                        if (!readString(key, nullptr) || !expect(':') || !skipValue(depth + 1))
+                            return false;
+                    } while (expect(','));
+
+                    return expect('}');
+                }
+                case '[': {
+                    ++p;
+
+                    if (peek(']'))
+                        return expect(']');
+
+                    do {
+                        if (!skipValue(depth + 1))
+                            return false;
+                    } while (expect(','));
+
+                    return expect(']');
+                }
+                case 't': return skipLiteral("true");
+                case 'f': return skipLiteral("false");
+                case 'n': return skipLiteral("null");
+                default: {
+                    int64_t ignored;
+                    return readNumber(ignored);
+                }
+            }
+        }
+
+        bool readMessage(ChatMessage& message)
+        {
+            if (!expect('{'))
+                return false;
+
+            message = {};
+
+            if (peek('}'))
+                return expect('}');
+
+            do {
+                std::string_view key;
+
+                if (!readString(key, nullptr) || !expect(':'))
+                    return false;
+
+                bool ok = true;
+
+                if (key == "nickname" && peek('"')) {
+                    std::string_view raw;
+                    ok = readString(raw, &message.nickname);
+                } else if (key == "message" && peek('"')) {
+                    std::string_view raw;
+                    ok = readString(raw, &message.text);
+                } else if (key == "createdAt" && !peek('"')) {
+                    ok = readNumber(message.createdAt);
+                } else {
+                    ok = skipValue();
+                }
+
+                if (!ok)
+                    return false;
+            } while (expect(','));
+
+            return expect('}');
+        }
+
+        bool readResponse(std::vector<ChatMessage>& out)
+        {
+            if (!expect('{'))
+                return false;
+
+            if (peek('}'))
+                return expect('}');
+
+            do {
+                std::string_view key;
+
+                if (!readString(key, nullptr) || !expect(':'))
+                    return false;
+
+                if (key == "messages" && peek('[')) {
+                    expect('[');
+
+                    if (!peek(']')) {
+                        do {
+                            ChatMessage message;
+
+                            if (!readMessage(message))
+                                return false;
+
+                            out.push_back(message);
+                        } while (expect(','));
+                    }
+
+                    if (!expect(']'))
+                        return false;
+                } else if (!skipValue()) {
+                    return false;
+                }
+            } while (expect(','));
+
+            return expect('}');
+        }
+    };
+
+    //==============================================================================
+    void appendEscaped(std::string& out, std::string_view s)
+    {
+        static const char* hex = "0123456789abcdef";
+
+        out += '"';
+
+        for (size_t i = 0; i < s.size(); ++i) {
+            auto c = static_cast<unsigned char>(s[i]);
+
+            switch (c) {
+                case '"':  out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                default:
+                    if (c < 0x20) {
+                        out += "\\u00";
+                        out += hex[c >> 4];
+                        out += hex[c & 0xf];
+                    } else if (c == 0xe2 && i + 2 < s.size()
+                               && static_cast<unsigned char>(s[i + 1]) == 0x80
+                               && (static_cast<unsigned char>(s[i + 2]) & 0xfe) == 0xa8) {
+                        // U+2028/U+2029 are valid in JSON but terminate a line in
+                        // older JavaScript engines, so escape them for the script.
+                        out += (s[i + 2] == '\xa8') ? "\\u2028" : "\\u2029";
+                        i += 2;
+                    } else {
+                        out += static_cast<char>(c);
+                    }
+            }
+        }
+
+        out += '"';
+    }
+}
+
+//==============================================================================
+char* ChatMessageArena::allocate(size_t numBytes)
+{
+    if (chunks.empty() || chunks.back().capacity - chunks.back().used < numBytes) {
+        Chunk chunk;
+        chunk.capacity = std::max(chunkSize, numBytes);
+        chunk.data.reset(new char[chunk.capacity]);
+        chunks.push_back(std::move(chunk));
+
+        ChatPipelineStats::get().allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    auto& chunk = chunks.back();
+    auto* result = chunk.data.get() + chunk.used;
+    chunk.used += numBytes;
+    return result;
+}
+
+void ChatMessageArena::reset()
+{
+    if (chunks.size() > 1) {
+        // Keep only the largest chunk around for the next response
+        auto largest = std::max_element(chunks.begin(), chunks.end(), [](auto& a, auto& b) {
+            return a.capacity < b.capacity;
+        });
+
+        Chunk keep = std::move(*largest);
+        chunks.clear();
+        chunks.push_back(std::move(keep));
+    }
+
+    if (!chunks.empty())
+        chunks.back().used = 0;
+}
+
+size_t ChatMessageArena::getNumBytesUsed() const
+{
+    size_t total = 0;
+
+    for (auto& chunk : chunks)
+        total += chunk.used;
+
+    return total;
+}
+
+//==============================================================================
+bool ChatMessageDecoder::decodeResponse(std::string_view json, ChatMessageArena& arena, std::vector<ChatMessage>& out)
+{
+    auto start = std::chrono::steady_clock::now();
+    auto numBefore = out.size();
+    auto capacityBefore = out.capacity();
+
+    Parser parser { json.data(), json.data() + json.size(), arena };
+    auto ok = parser.readResponse(out);
+
+    auto& stats = ChatPipelineStats::get();
+    stats.messagesDecoded.fetch_add(out.size() - numBefore, std::memory_order_relaxed);
+    stats.bytesDecoded.fetch_add(json.size(), std::memory_order_relaxed);
+    stats.decodeNanos.fetch_add(nanosSince(start), std::memory_order_relaxed);
+
+    if (out.capacity() != capacityBefore)
+        stats.allocations.fetch_add(1, std::memory_order_relaxed);
+
+    return ok;
+}
+
+bool ChatMessageDecoder::decodeMessage(std::string_view json, ChatMessageArena& arena, ChatMessage& out)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    Parser parser { json.data(), json.data() + json.size(), arena };
+    auto ok = parser.readMessage(out);
+
+    auto& stats = ChatPipelineStats::get();
+    stats.messagesDecoded.fetch_add(ok ? 1 : 0, std::memory_order_relaxed);
+    stats.bytesDecoded.fetch_add(json.size(), std::memory_order_relaxed);
+    stats.decodeNanos.fetch_add(nanosSince(start), std::memory_order_relaxed);
+
+    return ok;
+}
+
+//==============================================================================
+void appendChatMessageJson(std::string& out, ChatMessage const& message, uint64_t seq)
+{
+    auto start = std::chrono::steady_clock::now();
+    auto capacityBefore = out.capacity();
+
+    out += "{\"sender\":";
+    appendEscaped(out, message.nickname);
+    out += ",\"text\":";
+    appendEscaped(out, message.text);
+    out += ",\"timestamp\":";
+
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), message.createdAt);
+    out.append(digits, static_cast<size_t>(result.ptr - digits));
+
+    if (seq > 0) {
+        out += ",\"seq\":";
+        result = std::to_chars(digits, digits + sizeof(digits), seq);
+        out.append(digits, static_cast<size_t>(result.ptr - digits));
+    }
+
+    out += '}';
+
+    auto& stats = ChatPipelineStats::get();
+    stats.serializeNanos.fetch_add(nanosSince(start), std::memory_order_relaxed);
+
+    if (out.capacity() != capacityBefore)
+        stats.allocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+//==============================================================================
+ChatPipelineStats::Snapshot ChatPipelineStats::snapshot() const
+{
+    return {
+        messagesDecoded.load(std::memory_order_relaxed),
+        bytesDecoded.load(std::memory_order_relaxed),
+        allocations.load(std::memory_order_relaxed),
+        decodeNanos.load(std::memory_order_relaxed),
+        serializeNanos.load(std::memory_order_relaxed),
+    };
+}
+
+void ChatPipelineStats::reset()
+{
+    messagesDecoded = 0;
+    bytesDecoded = 0;
+    allocations = 0;
+    decodeNanos = 0;
+    serializeNanos = 0;
+}
+
+ChatPipelineStats& ChatPipelineStats::get()
+{
+    static ChatPipelineStats instance;
+    return instance;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+//==============================================================================
+// A flat, decoded chat message. The string views point into the ChatMessageArena
+// that the message was decoded into and stay valid until that arena is reset.
+struct ChatMessage
+{
+    std::string_view nickname;
+    std::string_view text;
+    int64_t createdAt = 0;
+};
+
+//==============================================================================
+// An owning copy of a message, for keeping it beyond the lifetime of the arena
+// it was decoded into.
+struct StoredChatMessage
+{
+    std::string nickname;
+    std::string text;
+    int64_t createdAt = 0;
+
+    StoredChatMessage() = default;
+    explicit StoredChatMessage(ChatMessage const& m)
+        : nickname(m.nickname), text(m.text), createdAt(m.createdAt) {}
+
+    ChatMessage view() const { return { nickname, text, createdAt }; }
+};
+
+//==============================================================================
+// Bump allocator backing the strings of one decoded response. Reset between
+// responses; the first chunk is kept so steady-state decoding does not allocate.
+class ChatMessageArena
+{
+public:
+    explicit ChatMessageArena(size_t initialChunkSize = 64 * 1024) : chunkSize(initialChunkSize) {}
+    ChatMessageArena(ChatMessageArena const&) = delete;
+    ChatMessageArena& operator=(ChatMessageArena const&) = delete;
+
+    char* allocate(size_t numBytes);
+    void reset();
+
+    size_t getNumBytesUsed() const;
+
+private:
+    struct Chunk
+    {
+        std::unique_ptr<char[]> data;
+        size_t capacity = 0;
+        size_t used = 0;
+    };
+
+    size_t chunkSize;
+    std::vector<Chunk> chunks;
+};
+
+//==============================================================================
+// Single-pass decoder for the chat API's JSON. Walks the input once and writes
+// the fields it cares about (nickname, message, createdAt) straight into
+// ChatMessage structs, skipping everything else without building a DOM.
+namespace ChatMessageDecoder
+{
+    // Decodes a {"messages": [...]} response body, appending to `out`. Returns
+    // false if the body is not well-formed; messages decoded so far are kept.
+    bool decodeResponse(std::string_view json, ChatMessageArena& arena, std::vector<ChatMessage>& out);
+
+    // Decodes a single message object.
+    bool decodeMessage(std::string_view json, ChatMessageArena& arena, ChatMessage& out);
+}
+
+//==============================================================================
+// Appends the WebView representation of a message, {"sender","text","timestamp"},
+// to `out`, plus its store sequence number as "seq" when one is given. Strings are
+// escaped so the result can be embedded in a script.
+void appendChatMessageJson(std::string& out, ChatMessage const& message, uint64_t seq = 0);
+
+//==============================================================================
+// Process-wide counters for the receive pipeline, so the per-message cost of
+// decoding and converting large backlogs can be measured.
+struct ChatPipelineStats
+{
+    std::atomic<uint64_t> messagesDecoded { 0 };
+    std::atomic<uint64_t> bytesDecoded { 0 };
+    std::atomic<uint64_t> allocations { 0 };
+    std::atomic<uint64_t> decodeNanos { 0 };
+    std::atomic<uint64_t> serializeNanos { 0 };
+
+    struct Snapshot
+    {
+        uint64_t messagesDecoded, bytesDecoded, allocations, decodeNanos, serializeNanos;
+    };
+
+    Snapshot snapshot() const;
+    void reset();
+
+    static ChatPipelineStats& get();
+};
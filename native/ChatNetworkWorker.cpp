@@ -0,0 +1,161 @@
+#include "ChatNetworkWorker.h"
+#include "Trace.h"
+
+//==============================================================================
+ChatNetworkWorker::ChatNetworkWorker()
+    : juce::Thread("ChatNetworkWorker"),
+      alive(std::make_shared<std::atomic<bool>>(true))
+{
+    // Started by the first request
+}
+
+ChatNetworkWorker::~ChatNetworkWorker()
+{
+    alive->store(false);
+
+    signalThreadShouldExit();
+    cancelPending();
+    wakeUp.signal();
+
+    // The active stream has been cancelled above, so this only waits for the
+    // worker to unwind out of the request it was in.
+    stopThread(2000);
+}
+
+//==============================================================================
+void ChatNetworkWorker::post(std::string const& endpoint, juce::String const& jsonBody, Completion onComplete,
+                             std::shared_ptr<Sequence> sequence)
+{
+    {
+        const juce::ScopedLock sl(lock);
+        queue.push_back({ endpoint, jsonBody, std::move(onComplete), std::move(sequence) });
+    }
+
+    if (!isThreadRunning())
+        startThread();
+
+    wakeUp.signal();
+}
+
+void ChatNetworkWorker::cancelPending()
+{
+    const juce::ScopedLock sl(lock);
+    queue.clear();
+    httpClient.cancel();
+
+    if (activeStream != nullptr)
+        activeStream->cancel();
+}
+
+//==============================================================================
+void ChatNetworkWorker::run()
+{
+    while (!threadShouldExit())
+    {
+        Request request;
+        bool hasRequest = false;
+
+        {
+            const juce::ScopedLock sl(lock);
+
+            if (!queue.empty()) {
+                request = std::move(queue.front());
+                queue.pop_front();
+                hasRequest = true;
+
+                // Anything queued before a cancelPending() is gone, so this one
+                // came after it; under the lock, so a cancel from now on sticks
+                httpClient.resume();
+            }
+        }
+
+        if (!hasRequest) {
+            wakeUp.wait(-1);
+            continue;
+        }
+
+        Response response;
+
+        if (request.sequence != nullptr && request.sequence->failed.load()) {
+            response.skipped = true;
+        } else {
+            response = perform(request);
+
+            if (request.sequence != nullptr && !response.ok)
+                request.sequence->failed = true;
+        }
+
+        if (request.onComplete && !threadShouldExit()) {
+            juce::MessageManager::callAsync([flag = alive, onComplete = std::move(request.onComplete), response]() {
+                if (flag->load())
+                    onComplete(response);
+            });
+        }
+    }
+}
+
+ChatHttpClient::Stats ChatNetworkWorker::getHttpStats() const
+{
+    return httpClient.getStats();
+}
+
+ChatNetworkWorker::Response ChatNetworkWorker::perform(Request const& request)
+{
+    ELEM_TRACE_SPAN("net", "chat.request");
+    Response response;
+
+    // Plain http goes through the pooled keep-alive client; anything else (e.g.
+    // https) falls back to a one-shot WebInputStream.
+    if (ChatHttpClient::supportsUrl(request.endpoint)) {
+        if (threadShouldExit())
+            return response;
+
+        auto httpResponse = httpClient.post(request.endpoint, request.body);
+
+        response.ok = httpResponse.ok;
+        response.statusCode = httpResponse.statusCode;
+        response.body = std::move(httpResponse.body);
+        response.timing = httpResponse.timing;
+
+        if (response.statusCode == 0)
+            DBG("ChatNetworkWorker request failed for " << juce::String(request.endpoint));
+
+        return response;
+    }
+
+    auto url = juce::URL(juce::String(request.endpoint)).withPOSTData(request.body);
+    juce::WebInputStream stream(url, true);
+
+    stream.withExtraHeaders("Content-Type: application/json")
+          .withConnectionTimeout(10000);
+
+    {
+        const juce::ScopedLock sl(lock);
+
+        if (threadShouldExit())
+            return response;
+
+        activeStream = &stream;
+    }
+
+    try {
+        if (stream.connect(nullptr) && !threadShouldExit()) {
+            response.statusCode = stream.getStatusCode();
+            response.body = stream.readEntireStreamAsString();
+            response.ok = !stream.isError() && response.statusCode >= 200 && response.statusCode < 300;
+        } else {
+            DBG("ChatNetworkWorker failed to connect to " << juce::String(request.endpoint));
+        }
+    } catch (const std::exception& e) {
+        DBG("Exception in ChatNetworkWorker::perform: " << e.what());
+    } catch (...) {
+        DBG("Unknown exception in ChatNetworkWorker::perform");
+    }
+
+    {
+        const juce::ScopedLock sl(lock);
+        activeStream = nullptr;
+    }
+
+    return response;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
+
+#include "ChatHttpClient.h"
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+
+
+//==============================================================================
+// A background thread that owns all blocking chat API traffic.
+//
+// Requests are queued from the message thread and executed one after another on
+// the worker. Completion callbacks are posted back to the message thread, so the
+// UI side never waits on a socket. Destroying the worker cancels the request in
+// flight, drops everything still queued, and guarantees that no completion
+// callback fires afterwards.
+class ChatNetworkWorker : private juce::Thread
+{
+public:
+    //==============================================================================
+    struct Response
+    {
+        bool ok = false;
+        int statusCode = 0;
+        juce::String body;
+        ChatHttpClient::Timing timing;
+
+        // Not sent, because a request ahead of it in its Sequence failed
+        bool skipped = false;
+    };
+
+    // Requests that share a Sequence reach the server in order or not at all:
+    // once one of them gets no 2xx response, the rest are skipped.
+    struct Sequence
+    {
+        std::atomic<bool> failed { false };
+    };
+
+    using Completion = std::function<void(Response const&)>;
+
+    //==============================================================================
+    ChatNetworkWorker();
+    ~ChatNetworkWorker() override;
+
+    //==============================================================================
+    // Queues a JSON POST to the given endpoint and returns immediately. The
+    // completion runs on the message thread once the request has finished.
+    void post(std::string const& endpoint, juce::String const& jsonBody, Completion onComplete,
+              std::shared_ptr<Sequence> sequence = nullptr);
+
+    // Drops all queued requests and aborts the one in flight, if any.
+    void cancelPending();
+
+    // Aggregate connect / first byte / total timings of the keep-alive client.
+    ChatHttpClient::Stats getHttpStats() const;
+
+private:
+    //==============================================================================
+    struct Request
+    {
+        std::string endpoint;
+        juce::String body;
+        Completion onComplete;
+        std::shared_ptr<Sequence> sequence;
+    };
+
+    void run() override;
+    Response perform(Request const& request);
+
+    //==============================================================================
+    ChatHttpClient httpClient;
+
+    juce::CriticalSection lock;
+    std::deque<Request> queue;
+    juce::WebInputStream* activeStream = nullptr;
+    juce::WaitableEvent wakeUp;
+
+    // Shared with every callback posted to the message thread; flipped to false
+    // in the destructor so late callbacks become no-ops.
+    std::shared_ptr<std::atomic<bool>> alive;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ChatNetworkWorker)
+};
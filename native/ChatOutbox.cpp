@@ -0,0 +1,210 @@
+#include "ChatOutbox.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace
+{
+    constexpr int kInitialBackoffMs = 500;
+    constexpr int kMaxBackoffMs = 30000;
+
+    // Ids of confirmed messages are remembered for a while so a later restore of
+    // an older project does not send them again.
+    constexpr size_t kMaxRecentlySent = 256;
+}
+
+//==============================================================================
+ChatOutbox::ChatOutbox(Send s, std::function<void()> sentCallback)
+    : send(std::move(s)),
+      onSent(std::move(sentCallback)),
+      alive(std::make_shared<bool>(true))
+{
+}
+
+ChatOutbox::~ChatOutbox()
+{
+    *alive = false;
+    stopTimer();
+}
+
+//==============================================================================
+void ChatOutbox::setMaxInFlight(int numRequests)
+{
+    maxInFlight = std::max(1, numRequests);
+}
+
+std::string ChatOutbox::enqueue(std::string nickname, std::string text)
+{
+    Item item;
+    item.message = { juce::Uuid().toString().toStdString(), std::move(nickname), std::move(text) };
+    item.enqueuedAtMs = juce::Time::getMillisecondCounter();
+
+    auto id = item.message.id;
+
+    {
+        const juce::ScopedLock sl(lock);
+        queue.push_back(std::move(item));
+    }
+
+    ++stats.queued;
+
+    pump();
+    return id;
+}
+
+void ChatOutbox::restore(std::vector<PendingMessage> const& messages)
+{
+    for (auto const& message : messages) {
+        if (message.id.empty() || isKnown(message.id))
+            continue;
+
+        Item item;
+        item.message = message;
+        item.enqueuedAtMs = juce::Time::getMillisecondCounter();
+
+        {
+            const juce::ScopedLock sl(lock);
+            queue.push_back(std::move(item));
+        }
+
+        ++stats.queued;
+    }
+
+    pump();
+}
+
+std::vector<ChatOutbox::PendingMessage> ChatOutbox::getPending() const
+{
+    const juce::ScopedLock sl(lock);
+
+    std::vector<PendingMessage> result;
+    result.reserve(queue.size());
+
+    for (auto const& item : queue)
+        result.push_back(item.message);
+
+    return result;
+}
+
+ChatOutbox::Stats ChatOutbox::getStats() const
+{
+    auto result = stats;
+    result.pending = queue.size();
+    return result;
+}
+
+ChatOutbox::Result ChatOutbox::resultForStatus(int statusCode)
+{
+    if (statusCode >= 200 && statusCode < 300)
+        return Result::sent;
+
+    // Timeouts and rate limiting are worth another try; anything else the
+    // server refused will be refused again
+    if (statusCode >= 400 && statusCode < 500 && statusCode != 408 && statusCode != 429)
+        return Result::rejected;
+
+    return Result::retry;
+}
+
+bool ChatOutbox::isKnown(std::string const& id) const
+{
+    for (auto const& item : queue)
+        if (item.message.id == id)
+            return true;
+
+    return std::find(recentlySent.begin(), recentlySent.end(), id) != recentlySent.end();
+}
+
+//==============================================================================
+void ChatOutbox::timerCallback()
+{
+    stopTimer();
+    pump();
+}
+
+void ChatOutbox::pump()
+{
+    if (failedAttempts > 0 && static_cast<juce::int32>(juce::Time::getMillisecondCounter() - retryAtMs) < 0)
+        return;
+
+    if (needsNewSequence && numInFlight > 0)
+        return;
+
+    for (auto& item : queue) {
+        if (numInFlight >= maxInFlight)
+            break;
+
+        if (item.inFlight)
+            continue;
+
+        item.inFlight = true;
+        ++numInFlight;
+
+        send(item.message, std::exchange(needsNewSequence, false), [this, flag = alive, id = item.message.id](Result result) {
+            if (*flag)
+                finished(id, result);
+        });
+    }
+}
+
+void ChatOutbox::finished(std::string const& id, Result result)
+{
+    auto it = std::find_if(queue.begin(), queue.end(), [&](Item const& item) { return item.message.id == id; });
+
+    if (it == queue.end())
+        return;
+
+    --numInFlight;
+    it->inFlight = false;
+
+    if (result != Result::sent)
+        needsNewSequence = true;
+
+    if (result == Result::skipped) {
+        pump();
+        return;
+    }
+
+    if (result == Result::retry) {
+        ++stats.retries;
+
+        // Jittered exponential backoff so many instances do not retry in lockstep
+        auto backoff = std::min(kMaxBackoffMs, kInitialBackoffMs << std::min(failedAttempts, 6));
+        auto jittered = backoff / 2 + juce::Random::getSystemRandom().nextInt(backoff / 2 + 1);
+
+        ++failedAttempts;
+        retryAtMs = juce::Time::getMillisecondCounter() + static_cast<juce::uint32>(jittered);
+
+        if (!isTimerRunning())
+            startTimer(jittered);
+
+        return;
+    }
+
+    if (result == Result::sent) {
+        auto const latency = static_cast<double>(juce::Time::getMillisecondCounter() - it->enqueuedAtMs);
+
+        ++stats.sent;
+        stats.totalLatencyMs += latency;
+        stats.maxLatencyMs = std::max(stats.maxLatencyMs, latency);
+        failedAttempts = 0;
+
+        recentlySent.push_back(id);
+
+        if (recentlySent.size() > kMaxRecentlySent)
+            recentlySent.pop_front();
+    } else {
+        DBG("Chat message " << juce::String(id) << " was rejected by the server");
+        ++stats.rejected;
+    }
+
+    {
+        const juce::ScopedLock sl(lock);
+        queue.erase(it);
+    }
+
+    if (result == Result::sent && onSent != nullptr)
+        onSent();
+
+    pump();
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <juce_events/juce_events.h>
+
+#include <deque>
+#include <memory>
+#include <functional>
+#include <string>
+#include <vector>
+
+
+//==============================================================================
+// Outbound chat messages that have not been confirmed by the server yet.
+//
+// enqueue() returns immediately. The outbox hands up to maxInFlight messages
+// at a time to its Send function, oldest first, so the network worker can run
+// them back to back on its keep-alive connection without a round trip through
+// the message thread in between. Messages handed over together form a
+// sequence that Send must deliver in order or not at all, so nothing already
+// handed over overtakes one that failed: those behind it come back skipped.
+// The outbox then waits for all of them before starting a new sequence from
+// the oldest message. A failed send is retried with jittered exponential
+// backoff, which holds back everything queued behind it. A message the server
+// refuses outright (a 4xx other than 408 or 429) is dropped. The pending
+// messages are saved with the project and restored from it, so nothing typed
+// while offline is lost.
+//
+// Message thread only, except for getPending(), which the host may call from
+// whichever thread saves the project.
+class ChatOutbox : private juce::Timer
+{
+public:
+    //==============================================================================
+    struct PendingMessage
+    {
+        // Random, so a restored message is not queued twice when several
+        // instances restore the same outbox
+        std::string id;
+        std::string nickname;
+        std::string text;
+    };
+
+    enum class Result
+    {
+        sent,
+        retry,
+        rejected,
+
+        // Not sent, because a message ahead of it in its sequence failed
+        skipped,
+    };
+
+    using Done = std::function<void(Result)>;
+
+    // Starts sending a message and calls done on the message thread when it has
+    // finished. startsSequence is set for the first message of a new sequence.
+    // Must not call back into the outbox synchronously.
+    using Send = std::function<void(PendingMessage const&, bool startsSequence, Done done)>;
+
+    struct Stats
+    {
+        uint64_t queued = 0;
+        uint64_t sent = 0;
+        uint64_t retries = 0;
+        uint64_t rejected = 0;
+        size_t pending = 0;
+
+        // From enqueue() to the server's confirmation
+        double totalLatencyMs = 0.0;
+        double maxLatencyMs = 0.0;
+    };
+
+    //==============================================================================
+    ChatOutbox(Send send, std::function<void()> onSent);
+    ~ChatOutbox() override;
+
+    //==============================================================================
+    void setMaxInFlight(int numRequests);
+
+    std::string enqueue(std::string nickname, std::string text);
+
+    // Queues saved messages behind the current ones, skipping any this outbox
+    // already has or has sent.
+    void restore(std::vector<PendingMessage> const& messages);
+
+    std::vector<PendingMessage> getPending() const;
+
+    Stats getStats() const;
+
+    // Result of an HTTP status code; 0 means the request never got a response.
+    static Result resultForStatus(int statusCode);
+
+private:
+    //==============================================================================
+    struct Item
+    {
+        PendingMessage message;
+        juce::uint32 enqueuedAtMs = 0;
+        bool inFlight = false;
+    };
+
+    void timerCallback() override;
+    void pump();
+    void finished(std::string const& id, Result result);
+    bool isKnown(std::string const& id) const;
+
+    //==============================================================================
+    Send send;
+    std::function<void()> onSent;
+
+    // Written on the message thread, under lock
+    juce::CriticalSection lock;
+    std::deque<Item> queue;
+    std::deque<std::string> recentlySent;
+    int maxInFlight = 4;
+    int numInFlight = 0;
+
+    // Set once a send has not gone through, so that the next send starts a new
+    // sequence when everything handed over before it has come back
+    bool needsNewSequence = true;
+
+    int failedAttempts = 0;
+    juce::uint32 retryAtMs = 0;
+
+    Stats stats;
+
+    // Shared with the completions handed to Send, which may outlive the outbox
+    std::shared_ptr<bool> alive;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ChatOutbox)
+};
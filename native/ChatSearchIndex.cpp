@@ -0,0 +1,429 @@
+#include "ChatSearchIndex.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+    // Trimming the posting lists waits for at least this many stale entries
+    constexpr size_t kMinStaleToCompact = 4096;
+
+    // Groups of more lists than this are checked against the forward index
+    constexpr size_t kMaxListsToSearch = 4;
+
+    // A prefix matching more terms than this is compared with each candidate's
+    // terms instead of being expanded
+    constexpr size_t kMaxTermsToExpand = 256;
+
+    bool isTermByte(unsigned char c)
+    {
+        // Bytes of multi-byte UTF-8 sequences are kept, so non-ASCII words are
+        // terms too (matched case-sensitively)
+        return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c >= 0x80;
+    }
+
+    std::string toLowerAscii(std::string_view text)
+    {
+        std::string lower(text);
+
+        for (auto& c : lower)
+            if (c >= 'A' && c <= 'Z')
+                c = static_cast<char>(c - 'A' + 'a');
+
+        return lower;
+    }
+}
+
+//==============================================================================
+void ChatSearchIndex::forEachTerm(std::string_view text, std::function<void(std::string_view)> const& fn)
+{
+    std::string current;
+
+    auto flush = [&] {
+        if (!current.empty()) {
+            fn(current);
+            current.clear();
+        }
+    };
+
+    for (auto ch : text) {
+        auto const c = static_cast<unsigned char>(ch);
+
+        if (!isTermByte(c)) {
+            flush();
+            continue;
+        }
+
+        if (current.size() < kMaxTermLength)
+            current += (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : ch;
+    }
+
+    flush();
+}
+
+//==============================================================================
+void ChatSearchIndex::add(uint64_t seq, ChatMessage const& message)
+{
+    if (!messages.empty() && seq != firstSeq + messages.size())
+        clear();
+
+    if (messages.empty())
+        firstSeq = seq;
+
+    auto const nickname = toLowerAscii(message.nickname);
+    auto found = nicknameIds.find(nickname);
+    uint32_t nicknameId = 0;
+
+    if (found != nicknameIds.end()) {
+        nicknameId = found->second;
+    } else {
+        nicknameId = static_cast<uint32_t>(nicknames.size());
+        nicknames.push_back(nickname);
+        nicknameIds.emplace(nickname, nicknameId);
+        nicknamePostings.emplace_back();
+    }
+
+    nicknamePostings[nicknameId].push_back(seq);
+
+    uint32_t added = 0;
+    auto const firstTerm = forwardBase + forwardTerms.size();
+
+    auto addTerm = [&](std::string_view termText) {
+        auto it = terms.find(termText);
+
+        if (it == terms.end()) {
+            it = terms.emplace(std::string(termText), Term()).first;
+            it->second.text = it->first;
+        }
+
+        if (addPosting(it->second.postings, seq)) {
+            forwardTerms.push_back(&it->second);
+            ++added;
+        }
+    };
+
+    // The sender's name is searchable like a word of the message
+    forEachTerm(message.text, addTerm);
+    forEachTerm(message.nickname, addTerm);
+
+    messages.push_back({ message.createdAt, nicknameId, added, firstTerm });
+}
+
+bool ChatSearchIndex::addPosting(PostingList& list, uint64_t seq)
+{
+    // A term repeated within one message is posted once
+    if (!list.empty() && list.back() == seq)
+        return false;
+
+    list.push_back(seq);
+    ++numPostings;
+    return true;
+}
+
+void ChatSearchIndex::removeBefore(uint64_t newFirstSeq)
+{
+    while (!messages.empty() && firstSeq < newFirstSeq) {
+        auto const numTerms = messages.front().numTerms;
+        stalePostings += numTerms;
+        forwardTerms.erase(forwardTerms.begin(), forwardTerms.begin() + numTerms);
+        forwardBase += numTerms;
+        messages.pop_front();
+        ++firstSeq;
+    }
+
+    if (messages.empty()) {
+        clear();
+        return;
+    }
+
+    if (stalePostings >= kMinStaleToCompact && stalePostings > numPostings - stalePostings)
+        compact();
+}
+
+void ChatSearchIndex::clear()
+{
+    terms.clear();
+    nicknames.clear();
+    nicknameIds.clear();
+    nicknamePostings.clear();
+    messages.clear();
+    forwardTerms.clear();
+    forwardBase = 0;
+    numPostings = 0;
+    stalePostings = 0;
+}
+
+void ChatSearchIndex::compact()
+{
+    auto trim = [this](PostingList& list) {
+        list.erase(list.begin(), std::lower_bound(list.begin(), list.end(), firstSeq));
+    };
+
+    for (auto it = terms.begin(); it != terms.end();) {
+        trim(it->second.postings);
+        it = it->second.postings.empty() ? terms.erase(it) : std::next(it);
+    }
+
+    // Nickname ids stay put, since live messages refer to them
+    for (auto& list : nicknamePostings)
+        trim(list);
+
+    numPostings -= stalePostings;
+    stalePostings = 0;
+}
+
+bool ChatSearchIndex::groupContains(Group& group, uint64_t seq) const
+{
+    if (!group.broad && group.lists.size() <= kMaxListsToSearch) {
+        if (group.cursors.empty())
+            for (auto const* list : group.lists)
+                group.cursors.push_back(list->size());
+
+        bool found = false;
+
+        for (size_t i = 0; i < group.lists.size(); ++i) {
+            auto const& list = *group.lists[i];
+            auto& cursor = group.cursors[i];
+
+            // Gallops back from the cursor, then searches the last step
+            size_t end = cursor;
+            size_t step = 1;
+
+            while (step <= end && list[end - step] > seq) {
+                end -= step;
+                step *= 2;
+            }
+
+            auto const begin = step > end ? 0 : end - step;
+            cursor = static_cast<size_t>(std::upper_bound(list.begin() + static_cast<std::ptrdiff_t>(begin),
+                                                          list.begin() + static_cast<std::ptrdiff_t>(end), seq) - list.begin());
+            found = found || (cursor > 0 && list[cursor - 1] == seq);
+        }
+
+        return found;
+    }
+
+    auto const& info = messages[static_cast<size_t>(seq - firstSeq)];
+    auto const begin = forwardTerms.begin() + static_cast<std::ptrdiff_t>(info.firstTerm - forwardBase);
+
+    if (group.broad) {
+        return std::any_of(begin, begin + info.numTerms, [&](Term const* t) {
+            return t->text.compare(0, group.prefix.size(), group.prefix) == 0;
+        });
+    }
+
+    return std::any_of(begin, begin + info.numTerms, [&](Term const* t) {
+        return t->markedBy == queryStamp && (t->groupBits & group.bit) != 0;
+    });
+}
+
+//==============================================================================
+uint64_t ChatSearchIndex::firstSeqAtOrAfter(int64_t timestamp) const
+{
+    auto it = std::lower_bound(messages.begin(), messages.end(), timestamp, [](MessageInfo const& m, int64_t t) {
+        return m.createdAt < t;
+    });
+
+    return firstSeq + static_cast<uint64_t>(it - messages.begin());
+}
+
+uint64_t ChatSearchIndex::lastSeqAtOrBefore(int64_t timestamp) const
+{
+    auto it = std::upper_bound(messages.begin(), messages.end(), timestamp, [](int64_t t, MessageInfo const& m) {
+        return t < m.createdAt;
+    });
+
+    // firstSeq - 1 (i.e. nothing) when every message is newer
+    return firstSeq + static_cast<uint64_t>(it - messages.begin()) - 1;
+}
+
+void ChatSearchIndex::search(Query const& query, Result& out) const
+{
+    out.seqs.clear();
+    out.totalMatches = 0;
+    out.totalIsExact = true;
+    out.nicknameCounts.clear();
+
+    if (messages.empty())
+        return;
+
+    auto lo = firstSeq;
+    auto hi = firstSeq + messages.size() - 1;
+
+    if (query.fromTimestamp != 0)
+        lo = std::max(lo, firstSeqAtOrAfter(query.fromTimestamp));
+
+    if (query.toTimestamp != 0)
+        hi = std::min(hi, lastSeqAtOrBefore(query.toTimestamp));
+
+    if (lo > hi)
+        return;
+
+    std::vector<std::string> queryTerms;
+
+    forEachTerm(query.text, [&](std::string_view term) {
+        queryTerms.emplace_back(term);
+    });
+
+    auto const lastIsPrefix = queryTerms.size() <= kMaxQueryTerms && !query.text.empty()
+                              && isTermByte(static_cast<unsigned char>(query.text.back()));
+
+    if (queryTerms.size() > kMaxQueryTerms)
+        queryTerms.resize(kMaxQueryTerms);
+
+    // One group per query term; a message matches if it is in at least one
+    // list of each group.
+    std::vector<Group> groups;
+    bool impossible = false;
+    ++queryStamp;
+
+    for (size_t i = 0; i < queryTerms.size(); ++i) {
+        auto const& prefix = queryTerms[i];
+
+        Group group;
+        group.bit = 1u << groups.size();
+
+        if (i + 1 < queryTerms.size() || !lastIsPrefix) {
+            auto found = terms.find(prefix);
+
+            if (found == terms.end()) {
+                impossible = true;
+                break;
+            }
+
+            group.lists.push_back(&found->second.postings);
+            group.numPostings = found->second.postings.size();
+            groups.push_back(std::move(group));
+            continue;
+        }
+
+        for (auto it = terms.lower_bound(prefix); it != terms.end() && it->first.compare(0, prefix.size(), prefix) == 0; ++it) {
+            if (group.lists.size() == kMaxTermsToExpand) {
+                // Never drives; terms marked so far are left for the stamp to expire
+                group.lists.clear();
+                group.numPostings = std::numeric_limits<size_t>::max();
+                group.broad = true;
+                group.prefix = prefix;
+                break;
+            }
+
+            auto const& term = it->second;
+            group.lists.push_back(&term.postings);
+            group.numPostings += term.postings.size();
+
+            if (term.markedBy != queryStamp) {
+                term.markedBy = queryStamp;
+                term.groupBits = 0;
+            }
+
+            term.groupBits |= group.bit;
+        }
+
+        impossible = impossible || (group.lists.empty() && !group.broad);
+        groups.push_back(std::move(group));
+    }
+
+    // The sender filter is a group of its own, always searched by its one list
+    Group senderGroup;
+
+    if (!query.nickname.empty()) {
+        auto found = nicknameIds.find(toLowerAscii(query.nickname));
+
+        if (found == nicknameIds.end())
+            return;
+
+        senderGroup.lists.push_back(&nicknamePostings[found->second]);
+        senderGroup.numPostings = nicknamePostings[found->second].size();
+    }
+
+    if (impossible)
+        return;
+
+    facetScratch.assign(nicknames.size(), 0);
+
+    auto matchesAllBut = [&](Group const* skip, uint64_t seq) {
+        if (!senderGroup.lists.empty() && &senderGroup != skip && !groupContains(senderGroup, seq))
+            return false;
+
+        for (auto& group : groups)
+            if (&group != skip && !groupContains(group, seq))
+                return false;
+
+        return true;
+    };
+
+    // Returns false once enough has been counted
+    auto accept = [&](uint64_t seq) {
+        if (out.seqs.size() < query.maxResults)
+            out.seqs.push_back(seq);
+
+        ++facetScratch[messages[static_cast<size_t>(seq - firstSeq)].nicknameId];
+        return ++out.totalMatches < kMaxCountedMatches;
+    };
+
+    Group const* driver = senderGroup.lists.empty() ? nullptr : &senderGroup;
+
+    for (auto const& group : groups)
+        if (driver == nullptr || group.numPostings < driver->numPostings)
+            driver = &group;
+
+    auto const rangeSize = static_cast<size_t>(hi - lo + 1);
+
+    if (driver == nullptr || driver->numPostings > rangeSize / 4) {
+        // Dense: walk the messages themselves
+        for (auto seq = hi; seq >= lo; --seq) {
+            if (matchesAllBut(nullptr, seq) && !accept(seq)) {
+                out.totalIsExact = seq == lo;
+                break;
+            }
+        }
+    } else {
+        // Walks the driver's lists newest first as one merged, de-duplicated
+        // sequence, keeping a max-heap of each list's current position
+        auto const& lists = driver->lists;
+        std::vector<std::pair<uint64_t, size_t>> heap;
+        std::vector<size_t> positions(lists.size());
+
+        for (size_t i = 0; i < lists.size(); ++i) {
+            auto const& list = *lists[i];
+            positions[i] = static_cast<size_t>(std::upper_bound(list.begin(), list.end(), hi) - list.begin());
+
+            if (positions[i] > 0 && list[positions[i] - 1] >= lo)
+                heap.emplace_back(list[--positions[i]], i);
+        }
+
+        std::make_heap(heap.begin(), heap.end());
+        uint64_t previous = 0;
+
+        while (!heap.empty()) {
+            std::pop_heap(heap.begin(), heap.end());
+            auto const [seq, index] = heap.back();
+            heap.pop_back();
+
+            auto const& list = *lists[index];
+
+            if (positions[index] > 0 && list[positions[index] - 1] >= lo) {
+                heap.emplace_back(list[--positions[index]], index);
+                std::push_heap(heap.begin(), heap.end());
+            }
+
+            if (seq == previous)
+                continue;
+
+            previous = seq;
+
+            if (matchesAllBut(driver, seq) && !accept(seq)) {
+                out.totalIsExact = heap.empty();
+                break;
+            }
+        }
+    }
+
+    for (size_t id = 0; id < facetScratch.size(); ++id)
+        if (facetScratch[id] > 0)
+            out.nicknameCounts.emplace_back(nicknames[id], facetScratch[id]);
+
+    std::sort(out.nicknameCounts.begin(), out.nicknameCounts.end(), [](auto const& a, auto const& b) {
+        return a.second > b.second;
+    });
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+#include "ChatMessage.h"
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+
+//==============================================================================
+// An incremental inverted index over the chat history, kept next to the
+// ChatHistoryStore and addressed by the same sequence numbers.
+//
+// Text and nickname are split into lowercased terms, each with a posting list of
+// the seqs it occurs in. Seqs only ever grow, so appending keeps every list
+// sorted. Evicting the oldest messages just moves a lower bound; the lists are
+// trimmed in one pass once as many entries are stale as live.
+//
+// A query is a set of terms that must all match, optionally narrowed to one
+// sender and a createdAt range. As in search-as-you-type, the last term is a
+// prefix of some term in the message unless the query ends in a separator; the
+// ones before it are complete words and must match exactly.
+// Matches come back newest first. The posting group with the fewest entries
+// drives and every candidate is checked against the other groups, so the cost
+// follows the rarest term rather than the history's size. A group of one or a
+// few terms is checked by binary search in its lists. A prefix that expands to
+// more terms instead marks those terms for the query, and the candidate's own
+// terms, kept per message in a small forward index, are checked for a mark; one
+// so short that it would expand to a large part of the vocabulary is not
+// expanded at all, and the candidate's terms are compared with it directly.
+// When even the rarest group covers a good part of the history, the messages are
+// simply walked newest first, since matches are then dense.
+//
+// Not thread-safe; the owner serialises access.
+class ChatSearchIndex
+{
+public:
+    //==============================================================================
+    struct Query
+    {
+        std::string text;
+
+        // Case-insensitive exact sender; empty for any
+        std::string nickname;
+
+        // Inclusive createdAt bounds; 0 leaves that end open
+        int64_t fromTimestamp = 0;
+        int64_t toTimestamp = 0;
+
+        size_t maxResults = 50;
+    };
+
+    struct Result
+    {
+        // Newest first, at most maxResults
+        std::vector<uint64_t> seqs;
+
+        // Matches are counted, and faceted by sender, up to kMaxCountedMatches
+        size_t totalMatches = 0;
+        bool totalIsExact = true;
+        std::vector<std::pair<std::string_view, size_t>> nicknameCounts;
+    };
+
+    static constexpr size_t kMaxCountedMatches = 1000;
+    static constexpr size_t kMaxTermLength = 32;
+
+    // Further terms in a query are ignored
+    static constexpr size_t kMaxQueryTerms = 16;
+
+    //==============================================================================
+    ChatSearchIndex() = default;
+
+    //==============================================================================
+    // Seqs must increase; a gap (e.g. after a clear) is fine.
+    void add(uint64_t seq, ChatMessage const& message);
+
+    // Forgets every message older than firstSeq.
+    void removeBefore(uint64_t firstSeq);
+
+    void clear();
+
+    // Reuses `out`'s storage.
+    void search(Query const& query, Result& out) const;
+
+    size_t size() const { return messages.size(); }
+    size_t getNumTerms() const { return terms.size(); }
+    size_t getNumPostings() const { return numPostings; }
+
+    // Calls fn for each lowercased term of the text, in order, duplicates included.
+    static void forEachTerm(std::string_view text, std::function<void(std::string_view)> const& fn);
+
+private:
+    //==============================================================================
+    using PostingList = std::vector<uint64_t>;
+
+    struct Term
+    {
+        PostingList postings;
+
+        // The term's own map key
+        std::string_view text;
+
+        // Set by a query to the groups this term belongs to, valid while
+        // markedBy is that query's stamp
+        mutable uint64_t markedBy = 0;
+        mutable uint32_t groupBits = 0;
+    };
+
+    // The lists of every term a query term is a prefix of
+    struct Group
+    {
+        std::vector<PostingList const*> lists;
+        size_t numPostings = 0;
+        uint32_t bit = 0;
+
+        // Set, with no lists, when the prefix matches too many terms to expand
+        bool broad = false;
+        std::string prefix;
+
+        // Candidates come newest first, so each list is searched from where the
+        // previous candidate left it; all entries from here on are newer
+        std::vector<size_t> cursors;
+    };
+
+    struct MessageInfo
+    {
+        int64_t createdAt = 0;
+        uint32_t nicknameId = 0;
+
+        // The message's distinct terms are forwardTerms[firstTerm - forwardBase]
+        // onwards; they become stale postings when it is evicted
+        uint32_t numTerms = 0;
+        uint64_t firstTerm = 0;
+    };
+
+    bool addPosting(PostingList& list, uint64_t seq);
+    bool groupContains(Group& group, uint64_t seq) const;
+    void compact();
+    uint64_t firstSeqAtOrAfter(int64_t timestamp) const;
+    uint64_t lastSeqAtOrBefore(int64_t timestamp) const;
+
+    //==============================================================================
+    std::map<std::string, Term, std::less<>> terms;
+    mutable uint64_t queryStamp = 0;
+
+    // Lowercased senders and the seqs of their messages, by id
+    std::vector<std::string> nicknames;
+    std::unordered_map<std::string, uint32_t> nicknameIds;
+    std::vector<PostingList> nicknamePostings;
+
+    // One entry per live message, the first being firstSeq
+    std::deque<MessageInfo> messages;
+    uint64_t firstSeq = 1;
+
+    // Each message's terms, as pointers into the map (whose nodes stay put, and
+    // are only erased once no live message has them)
+    std::deque<Term const*> forwardTerms;
+    uint64_t forwardBase = 0;
+
+    size_t numPostings = 0;
+    size_t stalePostings = 0;
+
+    // Facet counts by nickname id, reused between queries
+    mutable std::vector<size_t> facetScratch;
+};
@@ -0,0 +1,162 @@
+#include "ChatStreamReceiver.h"
+
+namespace
+{
+    constexpr int kInitialBackoffMs = 500;
+    constexpr int kMaxBackoffMs = 30000;
+}
+
+//==============================================================================
+ChatStreamReceiver::ChatStreamReceiver(std::string streamEndpoint, Callbacks cb)
+    : juce::Thread("ChatStreamReceiver"),
+      endpoint(std::move(streamEndpoint)),
+      callbacks(std::move(cb)),
+      alive(std::make_shared<std::atomic<bool>>(true))
+{
+}
+
+ChatStreamReceiver::~ChatStreamReceiver()
+{
+    alive->store(false);
+    stop();
+}
+
+//==============================================================================
+void ChatStreamReceiver::start()
+{
+    if (!isThreadRunning())
+        startThread();
+}
+
+void ChatStreamReceiver::stop()
+{
+    signalThreadShouldExit();
+    notify();
+
+    {
+        const juce::ScopedLock sl(lock);
+
+        if (activeStream != nullptr)
+            activeStream->cancel();
+    }
+
+    stopThread(2000);
+    connected.store(false);
+}
+
+//==============================================================================
+void ChatStreamReceiver::run()
+{
+    int attempt = 0;
+
+    while (!threadShouldExit())
+    {
+        auto cursor = callbacks.getCursor ? callbacks.getCursor() : 0;
+        auto url = juce::URL(juce::String(endpoint)).withParameter("fromTimestamp", juce::String(cursor));
+
+        juce::WebInputStream stream(url, false);
+        stream.withExtraHeaders("Accept: text/event-stream\nCache-Control: no-cache")
+              .withConnectionTimeout(10000);
+
+        {
+            const juce::ScopedLock sl(lock);
+
+            if (threadShouldExit())
+                break;
+
+            activeStream = &stream;
+        }
+
+        if (stream.connect(nullptr) && stream.getStatusCode() == 200) {
+            attempt = 0;
+            setConnected(true);
+            readStream(stream);
+        }
+
+        {
+            const juce::ScopedLock sl(lock);
+            activeStream = nullptr;
+        }
+
+        setConnected(false);
+
+        if (threadShouldExit())
+            break;
+
+        // Jittered exponential backoff so many instances do not reconnect in lockstep
+        auto backoff = std::min(kMaxBackoffMs, kInitialBackoffMs << std::min(attempt, 6));
+        auto jittered = backoff / 2 + juce::Random::getSystemRandom().nextInt(backoff / 2 + 1);
+        ++attempt;
+
+        wait(jittered);
+    }
+}
+
+void ChatStreamReceiver::readStream(juce::WebInputStream& stream)
+{
+    std::string line;
+    std::string data;
+
+    // Events are tiny and rare, so reading byte-wise keeps us from blocking on a
+    // partially filled buffer while the server is idle.
+    while (!threadShouldExit())
+    {
+        char c = 0;
+
+        if (stream.read(&c, 1) != 1)
+            return;
+
+        if (c != '\n') {
+            if (c != '\r')
+                line += c;
+
+            continue;
+        }
+
+        if (line.empty()) {
+            // A blank line terminates the event
+            if (!data.empty()) {
+                if (data.back() == '\n')
+                    data.pop_back();
+
+                post([this, payload = juce::String::fromUTF8(data.data(), static_cast<int>(data.size()))]() {
+                    if (callbacks.onEvent)
+                        callbacks.onEvent(payload);
+                });
+
+                data.clear();
+            }
+        } else if (line.rfind("data:", 0) == 0) {
+            auto value = std::string_view(line).substr(5);
+
+            if (!value.empty() && value.front() == ' ')
+                value.remove_prefix(1);
+
+            data.append(value);
+            data += '\n';
+        }
+
+        // Comments (heartbeats), "event:", "id:" and "retry:" lines carry nothing
+        // we need; the cursor we resume from comes from the messages themselves.
+        line.clear();
+    }
+}
+
+void ChatStreamReceiver::setConnected(bool isNowConnected)
+{
+    if (connected.exchange(isNowConnected) == isNowConnected)
+        return;
+
+    post([this, isNowConnected]() {
+        if (callbacks.onConnectionChanged)
+            callbacks.onConnectionChanged(isNowConnected);
+    });
+}
+
+void ChatStreamReceiver::post(std::function<void()> fn)
+{
+    juce::MessageManager::callAsync([flag = alive, fn = std::move(fn)]() {
+        if (flag->load())
+            fn();
+    });
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+
+//==============================================================================
+// Holds a long-lived Server-Sent Events connection to the chat API's stream
+// endpoint and forwards every event payload to the message thread.
+//
+// The stream is opened with the current cursor, so a reconnect resumes exactly
+// where the last delivered message left off. Dropped connections are retried with
+// jittered exponential backoff. The owner is told whenever the stream goes up or
+// down so it can fall back to polling while the stream is unavailable.
+class ChatStreamReceiver : private juce::Thread
+{
+public:
+    //==============================================================================
+    struct Callbacks
+    {
+        // Returns the createdAt of the newest message already received. Called on
+        // the receiver thread when (re)connecting.
+        std::function<int64_t()> getCursor;
+
+        // Called on the message thread with the data of each SSE event, which is
+        // a {"messages": [...]} document.
+        std::function<void(juce::String const&)> onEvent;
+
+        // Called on the message thread when the stream connects or drops.
+        std::function<void(bool connected)> onConnectionChanged;
+    };
+
+    //==============================================================================
+    ChatStreamReceiver(std::string streamEndpoint, Callbacks callbacks);
+    ~ChatStreamReceiver() override;
+
+    //==============================================================================
+    void start();
+    void stop();
+
+    bool isConnected() const { return connected.load(); }
+
+private:
+    //==============================================================================
+    void run() override;
+    void readStream(juce::WebInputStream& stream);
+    void setConnected(bool isNowConnected);
+    void post(std::function<void()> fn);
+
+    //==============================================================================
+    std::string endpoint;
+    Callbacks callbacks;
+
+    juce::CriticalSection lock;
+    juce::WebInputStream* activeStream = nullptr;
+    std::atomic<bool> connected { false };
+
+    std::shared_ptr<std::atomic<bool>> alive;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ChatStreamReceiver)
+};
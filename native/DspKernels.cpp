@@ -0,0 +1,170 @@
+#include "DspKernels.h"
+
+namespace DspKernels
+{
+    namespace
+    {
+        float driveGain(float drive)
+        {
+            return 1.0f + 9.0f * juce::jlimit(0.0f, 1.0f, drive);
+        }
+
+        // Even undriven, the curve has a gain of 1.5 at small signals, so the
+        // shaped signal is faded in over the first tenth of the drive range
+        // rather than switched in as drive leaves zero.
+        float shapedAmount(float drive)
+        {
+            return juce::jlimit(0.0f, 1.0f, drive * 10.0f);
+        }
+    }
+
+    //==============================================================================
+    BiquadCoefficients BiquadCoefficients::lowPass(double sampleRate, double frequency, double q)
+    {
+        auto const w0 = juce::MathConstants<double>::twoPi * juce::jlimit(10.0, sampleRate * 0.49, frequency) / sampleRate;
+        auto const cosW0 = std::cos(w0);
+        auto const alpha = std::sin(w0) / (2.0 * q);
+        auto const a0 = 1.0 + alpha;
+
+        BiquadCoefficients c;
+        c.b0 = static_cast<float>((1.0 - cosW0) / 2.0 / a0);
+        c.b1 = static_cast<float>((1.0 - cosW0) / a0);
+        c.b2 = c.b0;
+        c.a1 = static_cast<float>(-2.0 * cosW0 / a0);
+        c.a2 = static_cast<float>((1.0 - alpha) / a0);
+        return c;
+    }
+
+    //==============================================================================
+    // A register is its lanes' floats laid out contiguously, so frames can be
+    // filled through a plain float pointer with a stride of kLanes.
+    void interleave(const float* const* channels, size_t numChannels, size_t firstChannel,
+                    size_t numSamples, Vec* frames)
+    {
+        auto* raw = reinterpret_cast<float*>(frames);
+        auto const lanesUsed = std::min(kLanes, numChannels - firstChannel);
+
+        for (size_t lane = 0; lane < kLanes; ++lane) {
+            if (lane < lanesUsed) {
+                auto const* source = channels[firstChannel + lane];
+
+                for (size_t i = 0; i < numSamples; ++i)
+                    raw[i * kLanes + lane] = source[i];
+            } else {
+                for (size_t i = 0; i < numSamples; ++i)
+                    raw[i * kLanes + lane] = 0.0f;
+            }
+        }
+    }
+
+    void deinterleave(Vec const* frames, size_t numSamples, float* const* channels,
+                      size_t numChannels, size_t firstChannel)
+    {
+        auto const* raw = reinterpret_cast<const float*>(frames);
+        auto const lanesUsed = std::min(kLanes, numChannels - firstChannel);
+
+        for (size_t lane = 0; lane < lanesUsed; ++lane) {
+            auto* dest = channels[firstChannel + lane];
+
+            for (size_t i = 0; i < numSamples; ++i)
+                dest[i] = raw[i * kLanes + lane];
+        }
+    }
+
+    //==============================================================================
+    void gain(Vec* frames, size_t numFrames, float g)
+    {
+        auto const gv = Vec::expand(g);
+
+        for (size_t i = 0; i < numFrames; ++i)
+            frames[i] *= gv;
+    }
+
+    // Transposed direct form II, one independent filter per lane
+    void biquad(Vec* frames, size_t numFrames, BiquadCoefficients const& c, BiquadState& state)
+    {
+        auto const b0 = Vec::expand(c.b0), b1 = Vec::expand(c.b1), b2 = Vec::expand(c.b2);
+        auto const a1 = Vec::expand(c.a1), a2 = Vec::expand(c.a2);
+        auto z1 = state.z1, z2 = state.z2;
+
+        for (size_t i = 0; i < numFrames; ++i) {
+            auto const x = frames[i];
+            auto const y = b0 * x + z1;
+
+            z1 = b1 * x - a1 * y + z2;
+            z2 = b2 * x - a2 * y;
+            frames[i] = y;
+        }
+
+        state.z1 = z1;
+        state.z2 = z2;
+    }
+
+    void saturate(Vec* frames, size_t numFrames, float drive)
+    {
+        auto const g = Vec::expand(driveGain(drive));
+        auto const amount = Vec::expand(shapedAmount(drive));
+        auto const one = Vec::expand(1.0f), minusOne = Vec::expand(-1.0f);
+        auto const a = Vec::expand(1.5f), b = Vec::expand(0.5f);
+
+        for (size_t i = 0; i < numFrames; ++i) {
+            auto const x = frames[i];
+            auto const y = Vec::min(one, Vec::max(minusOne, x * g));
+            frames[i] = x + (y * (a - b * y * y) - x) * amount;
+        }
+    }
+
+    void mix(Vec* wet, Vec const* dry, size_t numFrames, float amount)
+    {
+        auto const m = Vec::expand(amount);
+
+        for (size_t i = 0; i < numFrames; ++i)
+            wet[i] = dry[i] + (wet[i] - dry[i]) * m;
+    }
+
+    void mix(Vec* wet, Vec const* dry, size_t numFrames, const float* amounts)
+    {
+        for (size_t i = 0; i < numFrames; ++i)
+            wet[i] = dry[i] + (wet[i] - dry[i]) * Vec::expand(amounts[i]);
+    }
+
+    //==============================================================================
+    namespace Reference
+    {
+        void gain(float* samples, size_t numSamples, float g)
+        {
+            for (size_t i = 0; i < numSamples; ++i)
+                samples[i] *= g;
+        }
+
+        void biquad(float* samples, size_t numSamples, BiquadCoefficients const& c, float& z1, float& z2)
+        {
+            for (size_t i = 0; i < numSamples; ++i) {
+                auto const x = samples[i];
+                auto const y = c.b0 * x + z1;
+
+                z1 = c.b1 * x - c.a1 * y + z2;
+                z2 = c.b2 * x - c.a2 * y;
+                samples[i] = y;
+            }
+        }
+
+        void saturate(float* samples, size_t numSamples, float drive)
+        {
+            auto const g = driveGain(drive);
+            auto const amount = shapedAmount(drive);
+
+            for (size_t i = 0; i < numSamples; ++i) {
+                auto const x = samples[i];
+                auto const y = juce::jlimit(-1.0f, 1.0f, x * g);
+                samples[i] = x + (y * (1.5f - 0.5f * y * y) - x) * amount;
+            }
+        }
+
+        void mix(float* wet, const float* dry, size_t numSamples, float amount)
+        {
+            for (size_t i = 0; i < numSamples; ++i)
+                wet[i] = dry[i] + (wet[i] - dry[i]) * amount;
+        }
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+
+//==============================================================================
+// The native effect chain's building blocks, vectorised with juce::dsp::SIMDRegister.
+//
+// The SIMD kernels work on interleaved frames: one register per sample frame,
+// one lane per channel, which is how a recursive filter can still use the
+// vector unit. Stateless kernels don't care about the layout and simply run
+// over every lane. Each kernel has a scalar reference in DspKernels::Reference,
+// working on one planar channel, which the SIMD version must match to within
+// float rounding; the headless harness checks this and benchmarks both.
+//
+// All kernels are real-time safe: no allocation, no locks.
+namespace DspKernels
+{
+    using Vec = juce::dsp::SIMDRegister<float>;
+    constexpr size_t kLanes = Vec::SIMDNumElements;
+
+    //==============================================================================
+    struct BiquadCoefficients
+    {
+        float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f, a1 = 0.0f, a2 = 0.0f;
+
+        // RBJ cookbook low-pass
+        static BiquadCoefficients lowPass(double sampleRate, double frequency, double q = 0.7071);
+    };
+
+    struct BiquadState
+    {
+        Vec z1 = Vec::expand(0.0f);
+        Vec z2 = Vec::expand(0.0f);
+    };
+
+    //==============================================================================
+    // Copies up to kLanes channels, starting at firstChannel, into the lanes of
+    // `frames`; unused lanes are zeroed.
+    void interleave(const float* const* channels, size_t numChannels, size_t firstChannel,
+                    size_t numSamples, Vec* frames);
+
+    void deinterleave(Vec const* frames, size_t numSamples, float* const* channels,
+                      size_t numChannels, size_t firstChannel);
+
+    //==============================================================================
+    void gain(Vec* frames, size_t numFrames, float gain);
+
+    void biquad(Vec* frames, size_t numFrames, BiquadCoefficients const& c, BiquadState& state);
+
+    // Cubic soft clip of the signal driven by 1 + 9 * drive (drive in 0..1),
+    // blended in from the dry signal as drive rises from 0 to 0.1
+    void saturate(Vec* frames, size_t numFrames, float drive);
+
+    // wet = dry + (wet - dry) * amount, with amount fixed or given per frame
+    void mix(Vec* wet, Vec const* dry, size_t numFrames, float amount);
+    void mix(Vec* wet, Vec const* dry, size_t numFrames, const float* amounts);
+
+    //==============================================================================
+    namespace Reference
+    {
+        void gain(float* samples, size_t numSamples, float gain);
+        void biquad(float* samples, size_t numSamples, BiquadCoefficients const& c, float& z1, float& z2);
+        void saturate(float* samples, size_t numSamples, float drive);
+        void mix(float* wet, const float* dry, size_t numSamples, float amount);
+    }
+}
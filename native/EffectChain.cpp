@@ -0,0 +1,74 @@
+#include "EffectChain.h"
+
+#include <algorithm>
+
+//==============================================================================
+void EffectChain::prepare(double newSampleRate, int newMaxBlockSize, int numChannels)
+{
+    using namespace DspKernels;
+
+    sampleRate = newSampleRate;
+    maxBlockSize = newMaxBlockSize;
+
+    wet.assign(static_cast<size_t>(maxBlockSize), Vec::expand(0.0f));
+    dry.assign(static_cast<size_t>(maxBlockSize), Vec::expand(0.0f));
+    filters.assign((static_cast<size_t>(numChannels) + kLanes - 1) / kLanes, BiquadState());
+
+    toneHzForCoefficients = -1.0f;
+    active = false;
+}
+
+void EffectChain::reset()
+{
+    for (auto& filter : filters)
+        filter = DspKernels::BiquadState();
+}
+
+//==============================================================================
+void EffectChain::process(float* const* channels, int numChannels, int numSamples,
+                          float drive, float toneHz, float mix, const float* mixRamp)
+{
+    using namespace DspKernels;
+
+    if (mixRamp == nullptr && mix <= 0.0f) {
+        if (active) {
+            reset();
+            active = false;
+        }
+
+        return;
+    }
+
+    active = true;
+
+    if (numSamples > maxBlockSize)
+        return;
+
+    if (toneHz != toneHzForCoefficients) {
+        tone = BiquadCoefficients::lowPass(sampleRate, toneHz);
+        toneHzForCoefficients = toneHz;
+    }
+
+    auto const n = static_cast<size_t>(numSamples);
+    auto const numGroups = std::min(filters.size(), (static_cast<size_t>(numChannels) + kLanes - 1) / kLanes);
+
+    for (size_t group = 0; group < numGroups; ++group) {
+        auto const firstChannel = group * kLanes;
+
+        interleave(channels, static_cast<size_t>(numChannels), firstChannel, n, wet.data());
+        std::copy(wet.begin(), wet.begin() + numSamples, dry.begin());
+
+        biquad(wet.data(), n, tone, filters[group]);
+
+        // At no drive the shaper would pass the signal through unchanged
+        if (drive > 0.0f)
+            saturate(wet.data(), n, drive);
+
+        if (mixRamp != nullptr)
+            DspKernels::mix(wet.data(), dry.data(), n, mixRamp);
+        else if (mix < 1.0f)
+            DspKernels::mix(wet.data(), dry.data(), n, mix);
+
+        deinterleave(wet.data(), n, channels, static_cast<size_t>(numChannels), firstChannel);
+    }
+}
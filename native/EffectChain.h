@@ -0,0 +1,39 @@
+#pragma once
+
+#include "DspKernels.h"
+
+#include <vector>
+
+
+//==============================================================================
+// The plugin's native insert: tone (low-pass), saturation and a dry/wet mix,
+// run on the output of the Elementary graph with the SIMD kernels.
+//
+// Channels are processed in groups of DspKernels::kLanes, one lane each. With
+// the mix at zero the chain is bypassed outright and costs nothing; its filter
+// state is cleared so it starts clean when brought back in.
+class EffectChain
+{
+public:
+    //==============================================================================
+    // Not real-time safe.
+    void prepare(double sampleRate, int maxBlockSize, int numChannels);
+    void reset();
+
+    // Audio thread. mixRamp, when given, holds numSamples per-sample mix values
+    // and takes precedence over mix.
+    void process(float* const* channels, int numChannels, int numSamples,
+                 float drive, float toneHz, float mix, const float* mixRamp);
+
+private:
+    //==============================================================================
+    double sampleRate = 44100.0;
+    int maxBlockSize = 0;
+
+    std::vector<DspKernels::Vec> wet, dry;
+    std::vector<DspKernels::BiquadState> filters;
+
+    DspKernels::BiquadCoefficients tone;
+    float toneHzForCoefficients = -1.0f;
+    bool active = false;
+};
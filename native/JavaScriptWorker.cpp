@@ -0,0 +1,413 @@
+#include "JavaScriptWorker.h"
+#include "Trace.h"
+
+#include <choc_javascript_QuickJS.h>
+
+#include <algorithm>
+#include <string_view>
+
+namespace
+{
+    // collectGarbageIfIdle() collects once the worker has had nothing to do for
+    // this long after running jobs
+    constexpr int kIdleGcDelayMs = 1000;
+
+    // ...or between jobs, once the heap has doubled since the last collection
+    // and is past this size
+    constexpr size_t kMinGcBytes = 1024 * 1024;
+
+    // Without a limit, QuickJS's own collector waits for this much
+    constexpr size_t kUnlimitedGcThreshold = 8 * 1024 * 1024;
+}
+
+//==============================================================================
+JavaScriptWorker::JavaScriptWorker(int timeoutMs, size_t memoryLimitBytes)
+    : juce::Thread("JavaScriptWorker"),
+      jobTimeoutMs(timeoutMs),
+      memoryLimit(memoryLimitBytes)
+{
+    // The thread is started by the first restart(), so an instance that never
+    // runs a script never has one
+}
+
+JavaScriptWorker::~JavaScriptWorker()
+{
+    stop();
+}
+
+//==============================================================================
+void JavaScriptWorker::restart(Job setup)
+{
+    {
+        const juce::ScopedLock sl(lock);
+        queue.clear();
+        queue.push_back({ std::move(setup), true });
+
+        // Cleared again by the worker when it picks up the setup job, so this
+        // only ever aborts work for the context being replaced.
+        interruptRequested = true;
+    }
+
+    if (!isThreadRunning())
+        startThread();
+
+    wakeUp.signal();
+}
+
+void JavaScriptWorker::post(Job job)
+{
+    {
+        const juce::ScopedLock sl(lock);
+        queue.push_back({ std::move(job), false });
+    }
+
+    wakeUp.signal();
+}
+
+void JavaScriptWorker::evaluate(std::string script)
+{
+    post([script = std::move(script)](choc::javascript::Context& ctx) {
+        ctx.evaluate(script);
+    });
+}
+
+void JavaScriptWorker::setMemoryLimit(size_t bytes)
+{
+    memoryLimit = bytes;
+
+    post([this](choc::javascript::Context&) {
+        applyMemoryLimit();
+    });
+}
+
+void JavaScriptWorker::collectGarbage()
+{
+    {
+        const juce::ScopedLock sl(lock);
+        queue.push_back({ nullptr, false, true });
+    }
+
+    wakeUp.signal();
+}
+
+void JavaScriptWorker::collectGarbageIfIdle()
+{
+    if (!isThreadRunning() || !jobsSinceGc.load() || idleGcRequested.exchange(true))
+        return;
+
+    wakeUp.signal();
+}
+
+void JavaScriptWorker::interrupt()
+{
+    interruptRequested = true;
+}
+
+void JavaScriptWorker::stop()
+{
+    if (!isThreadRunning())
+        return;
+
+    {
+        const juce::ScopedLock sl(lock);
+        queue.clear();
+    }
+
+    signalThreadShouldExit();
+    interruptRequested = true;
+    wakeUp.signal();
+
+    stopThread(jobTimeoutMs + 1000);
+}
+
+JavaScriptWorker::Stats JavaScriptWorker::getStats() const
+{
+    Stats stats;
+    stats.jobsRun = jobsRun.load();
+    stats.jobsInterrupted = jobsInterrupted.load();
+    stats.contextsCreated = contextsCreated.load();
+    stats.lastSetupMs = lastSetupMs.load();
+    stats.heapBytes = heapBytes.load();
+    stats.peakHeapBytes = peakHeapBytes.load();
+    stats.heapBytesAfterGc = heapBytesAfterGc.load();
+    stats.memoryLimitBytes = memoryLimit.load();
+    stats.objectCount = objectCount.load();
+    stats.outOfMemoryErrors = outOfMemoryErrors.load();
+    stats.gcRuns = gcRuns.load();
+    stats.lastGcMs = lastGcMs.load();
+    stats.maxGcMs = maxGcMs.load();
+    stats.totalGcMs = totalGcMs.load();
+    return stats;
+}
+
+juce::var JavaScriptWorker::toVar(Stats const& stats)
+{
+    auto* result = new juce::DynamicObject();
+    result->setProperty("jobsRun", static_cast<juce::int64>(stats.jobsRun));
+    result->setProperty("jobsInterrupted", static_cast<juce::int64>(stats.jobsInterrupted));
+    result->setProperty("contextsCreated", static_cast<juce::int64>(stats.contextsCreated));
+    result->setProperty("lastSetupMs", stats.lastSetupMs);
+    result->setProperty("heapBytes", static_cast<juce::int64>(stats.heapBytes));
+    result->setProperty("peakHeapBytes", static_cast<juce::int64>(stats.peakHeapBytes));
+    result->setProperty("heapBytesAfterGc", static_cast<juce::int64>(stats.heapBytesAfterGc));
+    result->setProperty("memoryLimitBytes", static_cast<juce::int64>(stats.memoryLimitBytes));
+    result->setProperty("objectCount", static_cast<juce::int64>(stats.objectCount));
+    result->setProperty("outOfMemoryErrors", static_cast<juce::int64>(stats.outOfMemoryErrors));
+    result->setProperty("gcRuns", static_cast<juce::int64>(stats.gcRuns));
+    result->setProperty("lastGcMs", stats.lastGcMs);
+    result->setProperty("maxGcMs", stats.maxGcMs);
+    result->setProperty("totalGcMs", stats.totalGcMs);
+    return juce::var(result);
+}
+
+//==============================================================================
+void JavaScriptWorker::run()
+{
+    while (!threadShouldExit())
+    {
+        Entry entry;
+        bool hasEntry = false;
+
+        {
+            const juce::ScopedLock sl(lock);
+
+            if (!queue.empty()) {
+                entry = std::move(queue.front());
+                queue.pop_front();
+                hasEntry = true;
+
+                interruptRequested = false;
+            }
+        }
+
+        if (!hasEntry) {
+            // Only ever looked at with the queue empty, which is what idle means
+            if (idleGcRequested.exchange(false)) {
+                auto const idleMs = static_cast<int>(juce::Time::getMillisecondCounter() - lastJobEndMs);
+
+                if (context != nullptr && jobsSinceGc.load() && idleMs >= kIdleGcDelayMs)
+                    runGarbageCollection();
+
+                continue;
+            }
+
+            wakeUp.wait(-1);
+            continue;
+        }
+
+        if (entry.collectsGarbage) {
+            if (context != nullptr)
+                runGarbageCollection();
+
+            continue;
+        }
+
+        auto const startTicks = juce::Time::getHighResolutionTicks();
+
+        try {
+            if (entry.createsContext) {
+                ELEM_TRACE_SPAN("js", "js.createContext");
+                context.reset();
+                quickjsContext = nullptr;
+                context = std::make_unique<choc::javascript::Context>(createContext());
+                ++contextsCreated;
+
+                heapBytesAfterGc = 0;
+                peakHeapBytes = 0;
+                applyMemoryLimit();
+            }
+
+            if (context == nullptr || !entry.job)
+                continue;
+
+            jobDeadline = juce::Time::getMillisecondCounter() + static_cast<juce::uint32>(jobTimeoutMs);
+            jobInterrupted = false;
+
+            ELEM_TRACE_SPAN("js", entry.createsContext ? "js.setup" : "js.job");
+            entry.job(*context);
+        } catch (const std::exception& e) {
+            DBG("Exception in JavaScriptWorker job: " << e.what());
+
+            if (std::string_view(e.what()).find("out of memory") != std::string_view::npos)
+                ++outOfMemoryErrors;
+        } catch (...) {
+            DBG("Unknown exception in JavaScriptWorker job");
+        }
+
+        if (jobInterrupted) {
+            DBG("JavaScriptWorker job was interrupted");
+            ++jobsInterrupted;
+            jobInterrupted = false;
+        }
+
+        if (entry.createsContext)
+            lastSetupMs = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) * 1000.0;
+
+        ++jobsRun;
+
+        if (context != nullptr) {
+            auto const heap = getHeapBytes();
+            heapBytes = heap;
+            Trace::counter("js", "js.heapBytes", static_cast<double>(heap));
+
+            if (heap > peakHeapBytes.load())
+                peakHeapBytes = heap;
+
+            jobsSinceGc = true;
+            lastJobEndMs = juce::Time::getMillisecondCounter();
+
+            bool moreWaiting = false;
+
+            {
+                const juce::ScopedLock sl(lock);
+                moreWaiting = !queue.empty();
+            }
+
+            // Queued work goes first; the idle collection catches up afterwards
+            if (!moreWaiting && heap > std::max(kMinGcBytes, 2 * heapBytesAfterGc.load()))
+                runGarbageCollection();
+        }
+    }
+
+    // The context is only ever touched on this thread, so it is destroyed here too
+    context.reset();
+    quickjsContext = nullptr;
+}
+
+//==============================================================================
+choc::javascript::Context JavaScriptWorker::createContext()
+{
+    namespace quickjs = choc::javascript::quickjs;
+
+    // Built from the QuickJS implementation directly, rather than through
+    // createQuickJSContext(), to reach its runtime for the interrupt handler.
+    auto pimpl = std::make_unique<quickjs::QuickJSContext>();
+
+    quickjs::JS_SetInterruptHandler(pimpl->runtime, [](quickjs::JSRuntime*, void* opaque) -> int {
+        auto* worker = static_cast<JavaScriptWorker*>(opaque);
+
+        if (!worker->shouldInterrupt())
+            return 0;
+
+        worker->jobInterrupted = true;
+        return 1;
+    }, this);
+
+    quickjsContext = pimpl.get();
+    return choc::javascript::Context(std::move(pimpl));
+}
+
+void JavaScriptWorker::applyMemoryLimit()
+{
+    namespace quickjs = choc::javascript::quickjs;
+
+    if (quickjsContext == nullptr)
+        return;
+
+    auto const limit = memoryLimit.load();
+    auto const live = heapBytesAfterGc.load();
+
+    // QuickJS treats 0 as no limit
+    quickjs::JS_SetMemoryLimit(quickjsContext->runtime, limit);
+
+    // Keeps QuickJS's allocation-driven collector, which would run inside a job,
+    // for when the heap is three quarters of the way from its live size to the
+    // limit. Everything short of that is collected between jobs.
+    auto const threshold = limit > live ? live + (limit - live) / 4 * 3
+                         : limit > 0 ? limit
+                         : std::max(kUnlimitedGcThreshold, 4 * live);
+
+    quickjs::JS_SetGCThreshold(quickjsContext->runtime, threshold);
+}
+
+void JavaScriptWorker::runGarbageCollection()
+{
+    namespace quickjs = choc::javascript::quickjs;
+
+    if (quickjsContext == nullptr)
+        return;
+
+    auto* runtime = quickjsContext->runtime;
+    auto const startTicks = juce::Time::getHighResolutionTicks();
+
+    {
+        ELEM_TRACE_SPAN("js", "js.gc");
+        quickjs::JS_RunGC(runtime);
+    }
+
+    auto const ms = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) * 1000.0;
+
+    quickjs::JSMemoryUsage usage;
+    quickjs::JS_ComputeMemoryUsage(runtime, &usage);
+
+    auto const live = static_cast<size_t>(usage.malloc_size);
+    heapBytes = live;
+    heapBytesAfterGc = live;
+    objectCount = static_cast<uint64_t>(usage.obj_count);
+
+    ++gcRuns;
+    lastGcMs = ms;
+    totalGcMs = totalGcMs.load() + ms;
+
+    if (ms > maxGcMs.load())
+        maxGcMs = ms;
+
+    jobsSinceGc = false;
+
+    // Moves the backstop threshold along with the live heap
+    applyMemoryLimit();
+}
+
+size_t JavaScriptWorker::getHeapBytes() const
+{
+    // Read straight from the runtime's allocator state, which is cheap enough to
+    // do after every job; JS_ComputeMemoryUsage walks the whole heap.
+    return quickjsContext != nullptr ? quickjsContext->runtime->malloc_state.malloc_size : 0;
+}
+
+bool JavaScriptWorker::shouldInterrupt() const
+{
+    if (interruptRequested.load(std::memory_order_relaxed))
+        return true;
+
+    // Wrap-safe comparison against the millisecond counter
+    auto const now = juce::Time::getMillisecondCounter();
+    return static_cast<juce::int32>(now - jobDeadline.load(std::memory_order_relaxed)) >= 0;
+}
+
+bool JavaScriptWorker::evaluateBytecode(const uint8_t* data, size_t size)
+{
+    namespace quickjs = choc::javascript::quickjs;
+
+    jassert(isWorkerThread());
+
+    if (quickjsContext == nullptr)
+        return false;
+
+    auto* ctx = quickjsContext->context;
+    auto function = quickjs::JS_ReadObject(ctx, data, size, JS_READ_OBJ_BYTECODE);
+
+    if (quickjs::JS_IsException(function)) {
+        quickjs::JS_FreeValue(ctx, quickjs::JS_GetException(ctx));
+        return false;
+    }
+
+    // JS_EvalFunction takes ownership of the function object
+    auto result = quickjs::JS_EvalFunction(ctx, function);
+
+    if (!quickjs::JS_IsException(result)) {
+        quickjs::JS_FreeValue(ctx, result);
+        return true;
+    }
+
+    // The script has started running by now, so this is reported like an error
+    // from evaluating the source rather than treated as unreadable bytecode.
+    auto error = quickjs::JS_GetException(ctx);
+    auto* message = quickjs::JS_ToCString(ctx, error);
+    std::string description = message != nullptr ? message : "Unknown error";
+
+    quickjs::JS_FreeCString(ctx, message);
+    quickjs::JS_FreeValue(ctx, error);
+
+    throw std::runtime_error(description);
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <choc_javascript.h>
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+
+namespace choc::javascript::quickjs { struct QuickJSContext; }
+
+//==============================================================================
+// A dedicated thread that owns the embedded QuickJS context.
+//
+// Nothing outside this class touches the context: other threads queue jobs that
+// run on the worker one after another, so a slow or looping script can never
+// stall the message or audio thread. Every job runs under a deadline; when it is
+// exceeded (or interrupt() is called) QuickJS's interrupt handler aborts the
+// script with an uncatchable error and the worker moves on to the next job.
+//
+// Native functions registered on the context are called on the worker thread.
+// Anything they need to do on the message thread must be posted there.
+//
+// The context's heap is capped by a memory limit; a script that exceeds it gets
+// an out-of-memory error rather than growing the host. Garbage is collected
+// between jobs, never inside one, so a bridge call is not held up by a
+// collection: once the heap has doubled since the last one, or when the owner
+// finds the worker idle, or when asked to. QuickJS's own allocation-driven
+// collector is kept back as a backstop near the limit.
+class JavaScriptWorker : private juce::Thread
+{
+public:
+    //==============================================================================
+    using Job = std::function<void(choc::javascript::Context&)>;
+
+    struct Stats
+    {
+        uint64_t jobsRun = 0;
+        uint64_t jobsInterrupted = 0;
+        uint64_t contextsCreated = 0;
+
+        // Time to create the last context and run its setup job
+        double lastSetupMs = 0.0;
+
+        // Heap of the current context. The object count is taken at each
+        // collection, when walking the heap is already paid for.
+        size_t heapBytes = 0;
+        size_t peakHeapBytes = 0;
+        size_t heapBytesAfterGc = 0;
+        size_t memoryLimitBytes = 0;
+        uint64_t objectCount = 0;
+        uint64_t outOfMemoryErrors = 0;
+
+        uint64_t gcRuns = 0;
+        double lastGcMs = 0.0;
+        double maxGcMs = 0.0;
+        double totalGcMs = 0.0;
+    };
+
+    static constexpr size_t kDefaultMemoryLimit = 64 * 1024 * 1024;
+
+    //==============================================================================
+    explicit JavaScriptWorker(int jobTimeoutMs = 2000, size_t memoryLimitBytes = kDefaultMemoryLimit);
+    ~JavaScriptWorker() override;
+
+    //==============================================================================
+    // Drops everything still queued, interrupts the job in flight, and then
+    // replaces the context with a fresh one on which `setup` is run.
+    void restart(Job setup);
+
+    // Queues a job for the current context. Jobs queued before the first
+    // restart(), or while no context exists, are dropped.
+    void post(Job job);
+
+    // Queues a script for evaluation; errors are logged and otherwise ignored.
+    void evaluate(std::string script);
+
+    // Applies to the current context and every one created after it; 0 removes
+    // the limit.
+    void setMemoryLimit(size_t bytes);
+
+    // Queues a full collection, which runs once the jobs ahead of it are done.
+    void collectGarbage();
+
+    // Asks for a collection that only runs if the script has run since the last
+    // one and the worker has been idle for a second since. Meant to be called
+    // periodically, as background work: it queues nothing, and does not wake
+    // the worker when there is nothing to collect or a request is pending.
+    void collectGarbageIfIdle();
+
+    // Aborts the job that is currently running, if any.
+    void interrupt();
+
+    // Interrupts and joins the worker and destroys the context. Called by the
+    // destructor, or earlier by an owner whose callbacks the context references.
+    void stop();
+
+    // Worker thread only, i.e. from within a job: evaluates QuickJS bytecode as
+    // written by JS_WriteObject in the current context. Returns false, without
+    // running anything, if the bytecode cannot be read; throws like
+    // Context::evaluate() if the script itself throws.
+    bool evaluateBytecode(const uint8_t* data, size_t size);
+
+    bool isWorkerThread() const { return juce::Thread::getCurrentThreadId() == getThreadId(); }
+
+    Stats getStats() const;
+    static juce::var toVar(Stats const& stats);
+
+private:
+    //==============================================================================
+    struct Entry
+    {
+        Job job;
+        bool createsContext = false;
+        bool collectsGarbage = false;
+    };
+
+    void run() override;
+    choc::javascript::Context createContext();
+    bool shouldInterrupt() const;
+    void applyMemoryLimit();
+    void runGarbageCollection();
+    size_t getHeapBytes() const;
+
+    //==============================================================================
+    int const jobTimeoutMs;
+
+    juce::CriticalSection lock;
+    std::deque<Entry> queue;
+    juce::WaitableEvent wakeUp;
+
+    std::atomic<bool> interruptRequested { false };
+    std::atomic<juce::uint32> jobDeadline { 0 };
+    std::atomic<bool> jobInterrupted { false };
+
+    // Written by the worker; read by collectGarbageIfIdle()
+    std::atomic<bool> jobsSinceGc { false };
+    std::atomic<bool> idleGcRequested { false };
+
+    std::atomic<uint64_t> jobsRun { 0 };
+    std::atomic<uint64_t> jobsInterrupted { 0 };
+    std::atomic<uint64_t> contextsCreated { 0 };
+    std::atomic<double> lastSetupMs { 0.0 };
+
+    std::atomic<size_t> memoryLimit;
+    std::atomic<size_t> heapBytes { 0 };
+    std::atomic<size_t> peakHeapBytes { 0 };
+    std::atomic<size_t> heapBytesAfterGc { 0 };
+    std::atomic<uint64_t> objectCount { 0 };
+    std::atomic<uint64_t> outOfMemoryErrors { 0 };
+    std::atomic<uint64_t> gcRuns { 0 };
+    std::atomic<double> lastGcMs { 0.0 };
+    std::atomic<double> maxGcMs { 0.0 };
+    std::atomic<double> totalGcMs { 0.0 };
+
+    // Worker thread only
+    std::unique_ptr<choc::javascript::Context> context;
+    choc::javascript::quickjs::QuickJSContext* quickjsContext = nullptr;
+    juce::uint32 lastJobEndMs = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(JavaScriptWorker)
+};
@@ -0,0 +1,237 @@
+#include "LogChannel.h"
+
+#include <cstdio>
+
+namespace
+{
+    // How often the ring is drained, and how much of it goes into one batch
+    constexpr int kDrainIntervalMs = 100;
+    constexpr size_t kMaxBatchRecords = 256;
+
+    const char* getLevelName(LogRing::Level level)
+    {
+        switch (level) {
+            case LogRing::Level::debug:   return "debug";
+            case LogRing::Level::info:    return "log";
+            case LogRing::Level::warning: return "warn";
+            case LogRing::Level::error:   return "error";
+        }
+
+        return "log";
+    }
+
+    void appendJsonString(std::string& out, std::string_view text)
+    {
+        out += '"';
+
+        for (auto c : text) {
+            switch (c) {
+                case '"':  out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        char escaped[8];
+                        std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+                        out += escaped;
+                    } else {
+                        out += c;
+                    }
+            }
+        }
+
+        out += '"';
+    }
+}
+
+//==============================================================================
+LogChannel::LogChannel(EditorSink sink, size_t capacity)
+    : juce::Thread("LogChannel"),
+      editorSink(std::move(sink)),
+      ring(capacity)
+{
+    // Started by the first write
+}
+
+LogChannel::~LogChannel()
+{
+    signalThreadShouldExit();
+    notify();
+    stopThread(1000);
+}
+
+//==============================================================================
+void LogChannel::setForwardingToEditor(bool shouldForward)
+{
+    forwardingToEditor = shouldForward;
+}
+
+void LogChannel::setLogFile(juce::File const& file, juce::int64 maxBytes, int backups)
+{
+    const juce::ScopedLock sl(fileLock);
+
+    fileStream.reset();
+    logFile = file;
+    maxFileBytes = maxBytes;
+    maxBackups = backups;
+    writingToFile = file != juce::File();
+}
+
+bool LogChannel::isActive() const
+{
+#if JUCE_DEBUG
+    return true;
+#else
+    return forwardingToEditor.load() || writingToFile.load();
+#endif
+}
+
+bool LogChannel::write(Level level, std::string_view text)
+{
+    if (!isActive())
+        return false;
+
+    if (!isThreadRunning())
+        startThread(juce::Thread::Priority::low);
+
+    return ring.push(level, text);
+}
+
+LogChannel::Stats LogChannel::getStats() const
+{
+    return { ring.getTotalPushed(), recordsDropped.load(), batchesToEditor.load(), bytesToFile.load() };
+}
+
+//==============================================================================
+void LogChannel::run()
+{
+    while (!threadShouldExit()) {
+        wait(kDrainIntervalMs);
+        drain();
+    }
+
+    // Whatever is left when the channel goes away still reaches the file
+    drain();
+
+    const juce::ScopedLock sl(fileLock);
+    fileStream.reset();
+}
+
+void LogChannel::drain()
+{
+    auto const toEditor = forwardingToEditor.load() && editorSink != nullptr;
+    auto const toFile = writingToFile.load();
+
+    for (;;) {
+        editorBatch.clear();
+        fileBatch.clear();
+
+        auto const count = ring.drain([&](LogRing::Record const& record) {
+            auto const text = record.getText();
+            auto const* levelName = getLevelName(record.level);
+
+            DBG("[embedded:" << levelName << "] " << juce::String(text.data(), text.size()));
+
+            if (toEditor) {
+                editorBatch += editorBatch.empty() ? "[" : ",";
+                editorBatch += "[\"";
+                editorBatch += levelName;
+                editorBatch += "\",";
+                appendJsonString(editorBatch, record.truncated ? std::string(text) + "..." : std::string(text));
+                editorBatch += "]";
+            }
+
+            if (toFile) {
+                fileBatch += juce::Time(record.timeMs).toISO8601(true).toStdString();
+                fileBatch += " ";
+                fileBatch += levelName;
+                fileBatch += " ";
+                fileBatch += text;
+                fileBatch += record.truncated ? "...\n" : "\n";
+            }
+        }, kMaxBatchRecords);
+
+        auto const dropped = ring.takeDroppedCount();
+        recordsDropped += dropped;
+        droppedUnreported += dropped;
+
+        if (count == 0 && droppedUnreported == 0)
+            return;
+
+        if (droppedUnreported > 0) {
+            auto const note = std::to_string(droppedUnreported) + " log records dropped";
+
+            if (toEditor) {
+                editorBatch += editorBatch.empty() ? "[" : ",";
+                editorBatch += "[\"warn\",\"" + note + "\"]";
+            }
+
+            if (toFile)
+                fileBatch += note + "\n";
+
+            droppedUnreported = 0;
+        }
+
+        if (toEditor && !editorBatch.empty()) {
+            editorBatch += "]";
+            editorSink("(function(records) {\n"
+                       "  for (const [level, text] of records)\n"
+                       "    (console[level] || console.log)('[embedded:' + level + ']', text);\n"
+                       "})(" + editorBatch + ");");
+            ++batchesToEditor;
+        }
+
+        if (toFile && !fileBatch.empty())
+            writeToFile(fileBatch);
+
+        if (count < kMaxBatchRecords)
+            return;
+    }
+}
+
+//==============================================================================
+void LogChannel::writeToFile(std::string const& lines)
+{
+    const juce::ScopedLock sl(fileLock);
+
+    if (logFile == juce::File())
+        return;
+
+    if (fileStream == nullptr || fileStream->getPosition() >= maxFileBytes) {
+        fileStream.reset();
+
+        if (logFile.getSize() >= maxFileBytes)
+            rotateLogFile();
+
+        fileStream = std::make_unique<juce::FileOutputStream>(logFile);
+
+        if (fileStream->failedToOpen()) {
+            DBG("Could not open log file " << logFile.getFullPathName());
+            fileStream.reset();
+            return;
+        }
+    }
+
+    fileStream->write(lines.data(), lines.size());
+    fileStream->flush();
+    bytesToFile += lines.size();
+}
+
+void LogChannel::rotateLogFile()
+{
+    auto backup = [this](int index) {
+        return logFile.getSiblingFile(logFile.getFileName() + "." + juce::String(index));
+    };
+
+    backup(maxBackups).deleteFile();
+
+    for (int i = maxBackups - 1; i >= 1; --i)
+        backup(i).moveFileTo(backup(i + 1));
+
+    if (maxBackups > 0)
+        logFile.moveFileTo(backup(1));
+    else
+        logFile.deleteFile();
+}
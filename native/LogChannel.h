@@ -0,0 +1,88 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include "LogRing.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+
+
+//==============================================================================
+// The native side of the embedded script's console.
+//
+// write() only copies the text into a LogRing; a background thread drains it a
+// few times a second and hands each batch to the editor as one script, appends
+// it to a size-rotated log file, or both. With neither sink enabled, isActive()
+// is false and callers skip formatting their message altogether. Debug builds
+// also echo every record through DBG and so are always active.
+class LogChannel : private juce::Thread
+{
+public:
+    //==============================================================================
+    using Level = LogRing::Level;
+
+    // Evaluates a script in the editor; called on the log thread.
+    using EditorSink = std::function<void(std::string script)>;
+
+    struct Stats
+    {
+        uint64_t recordsWritten = 0;
+        uint64_t recordsDropped = 0;
+        uint64_t batchesToEditor = 0;
+        uint64_t bytesToFile = 0;
+    };
+
+    //==============================================================================
+    explicit LogChannel(EditorSink editorSink, size_t capacity = 1024);
+    ~LogChannel() override;
+
+    //==============================================================================
+    // Turned on while an editor page is there to show the records.
+    void setForwardingToEditor(bool shouldForward);
+
+    // Appends every record to the given file, renaming it to file.1, file.2, ...
+    // once it grows past maxBytes. An empty File turns the file sink off.
+    void setLogFile(juce::File const& file, juce::int64 maxBytes = 1024 * 1024, int maxBackups = 3);
+
+    bool isActive() const;
+
+    // Any thread. Returns false if the record was dropped.
+    bool write(Level level, std::string_view text);
+
+    Stats getStats() const;
+
+private:
+    //==============================================================================
+    void run() override;
+    void drain();
+    void writeToFile(std::string const& lines);
+    void rotateLogFile();
+
+    //==============================================================================
+    EditorSink editorSink;
+    LogRing ring;
+
+    std::atomic<bool> forwardingToEditor { false };
+    std::atomic<bool> writingToFile { false };
+
+    // Log thread, except while setLogFile() swaps them under fileLock
+    juce::CriticalSection fileLock;
+    juce::File logFile;
+    juce::int64 maxFileBytes = 0;
+    int maxBackups = 0;
+    std::unique_ptr<juce::FileOutputStream> fileStream;
+
+    // Log thread only
+    std::string editorBatch;
+    std::string fileBatch;
+    uint64_t droppedUnreported = 0;
+
+    std::atomic<uint64_t> recordsDropped { 0 };
+    std::atomic<uint64_t> batchesToEditor { 0 };
+    std::atomic<uint64_t> bytesToFile { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LogChannel)
+};
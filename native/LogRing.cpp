@@ -0,0 +1,96 @@
+#include "LogRing.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace
+{
+    size_t nextPowerOfTwo(size_t n)
+    {
+        size_t result = 2;
+
+        while (result < n)
+            result <<= 1;
+
+        return result;
+    }
+
+    int64_t millisecondsNow()
+    {
+        using namespace std::chrono;
+        return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+    }
+}
+
+//==============================================================================
+LogRing::LogRing(size_t requestedCapacity)
+    : capacity(nextPowerOfTwo(requestedCapacity)),
+      slots(std::make_unique<Slot[]>(capacity))
+{
+    // A slot is free for the producer claiming position p once its sequence is p,
+    // and holds a record for the consumer once it is p + 1.
+    for (size_t i = 0; i < capacity; ++i)
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+//==============================================================================
+bool LogRing::push(Level level, std::string_view text)
+{
+    auto const mask = capacity - 1;
+    auto position = enqueuePosition.load(std::memory_order_relaxed);
+    Slot* slot = nullptr;
+
+    for (;;) {
+        slot = &slots[position & mask];
+
+        auto const sequence = slot->sequence.load(std::memory_order_acquire);
+        auto const difference = static_cast<std::ptrdiff_t>(sequence - position);
+
+        if (difference == 0) {
+            if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                break;
+        } else if (difference < 0) {
+            // The consumer has not freed this slot yet: the ring is full
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            position = enqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+
+    auto& record = slot->record;
+    auto const length = std::min(text.size(), kMaxTextLength);
+
+    record.timeMs = millisecondsNow();
+    record.level = level;
+    record.truncated = length < text.size();
+    record.length = static_cast<uint8_t>(length);
+    std::memcpy(record.text.data(), text.data(), length);
+
+    slot->sequence.store(position + 1, std::memory_order_release);
+    pushed.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+size_t LogRing::drain(std::function<void(Record const&)> const& callback, size_t maxRecords)
+{
+    auto const mask = capacity - 1;
+    size_t count = 0;
+
+    while (count < maxRecords) {
+        auto& slot = slots[dequeuePosition & mask];
+
+        if (slot.sequence.load(std::memory_order_acquire) != dequeuePosition + 1)
+            break;
+
+        callback(slot.record);
+
+        // Frees the slot for the producer that comes round the ring next
+        slot.sequence.store(dequeuePosition + capacity, std::memory_order_release);
+        ++dequeuePosition;
+        ++count;
+    }
+
+    return count;
+}
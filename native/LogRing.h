@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string_view>
+
+
+//==============================================================================
+// A bounded, lock-free multi-producer / single-consumer queue of log records.
+//
+// Every slot has a fixed-size text buffer, so push() never allocates or blocks
+// and can be called from any thread, the audio thread included. Text longer
+// than a slot is truncated. When the ring is full the record is dropped and
+// counted instead of waiting for the consumer.
+class LogRing
+{
+public:
+    //==============================================================================
+    enum class Level : uint8_t
+    {
+        debug,
+        info,
+        warning,
+        error,
+    };
+
+    static constexpr size_t kMaxTextLength = 240;
+
+    struct Record
+    {
+        int64_t timeMs = 0; // Wall clock, milliseconds since 1970
+        Level level = Level::info;
+        bool truncated = false;
+        uint8_t length = 0;
+        std::array<char, kMaxTextLength> text;
+
+        std::string_view getText() const { return { text.data(), length }; }
+    };
+
+    //==============================================================================
+    // The capacity is rounded up to a power of two.
+    explicit LogRing(size_t capacity = 1024);
+
+    //==============================================================================
+    // Any thread. Returns false if the record was dropped because the ring is full.
+    bool push(Level level, std::string_view text);
+
+    // Consumer thread only. Hands up to maxRecords records to the callback, oldest
+    // first, and returns how many that was.
+    size_t drain(std::function<void(Record const&)> const& callback, size_t maxRecords);
+
+    size_t getCapacity() const { return capacity; }
+
+    // Records dropped since the last call, for reporting them alongside a batch.
+    uint64_t takeDroppedCount() { return dropped.exchange(0); }
+
+    uint64_t getTotalPushed() const { return pushed.load(); }
+
+private:
+    //==============================================================================
+    struct Slot
+    {
+        std::atomic<size_t> sequence { 0 };
+        Record record;
+    };
+
+    size_t const capacity;
+    std::unique_ptr<Slot[]> slots;
+
+    alignas(64) std::atomic<size_t> enqueuePosition { 0 };
+    alignas(64) size_t dequeuePosition = 0;
+
+    std::atomic<uint64_t> dropped { 0 };
+    std::atomic<uint64_t> pushed { 0 };
+};
@@ -0,0 +1,162 @@
+#include "ParameterBank.h"
+
+#if defined(_MSC_VER)
+ #include <intrin.h>
+#endif
+
+namespace
+{
+    // Index of the lowest set bit; x must be non-zero
+    inline size_t lowestSetBit(uint64_t x)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward64(&index, x);
+        return static_cast<size_t>(index);
+#else
+        return static_cast<size_t>(__builtin_ctzll(x));
+#endif
+    }
+
+    // Calls fn(index) for every set bit of the mask
+    template <typename Fn>
+    inline void forEachSetBit(uint64_t word, size_t wordIndex, Fn&& fn)
+    {
+        while (word != 0) {
+            fn(wordIndex * 64 + lowestSetBit(word));
+            word &= word - 1;
+        }
+    }
+}
+
+//==============================================================================
+ParameterBank::ParameterBank(std::vector<Spec> s)
+    : specs(std::move(s)),
+      targets(new std::atomic<float>[specs.size()]),
+      voices(specs.size())
+{
+    jassert(specs.size() <= kMaxParameters);
+
+    for (size_t i = 0; i < specs.size(); ++i) {
+        targets[i].store(specs[i].defaultValue);
+        voices[i].current = voices[i].target = specs[i].defaultValue;
+    }
+}
+
+int ParameterBank::indexOf(std::string const& id) const
+{
+    for (size_t i = 0; i < specs.size(); ++i)
+        if (specs[i].id == id)
+            return static_cast<int>(i);
+
+    return -1;
+}
+
+//==============================================================================
+void ParameterBank::prepare(double sampleRate, int newMaxBlockSize, double smoothingSeconds)
+{
+    maxBlockSize = std::max(1, newMaxBlockSize);
+    smoothingSamples = std::max(1, juce::roundToInt(sampleRate * smoothingSeconds));
+
+    ramps.setSize(static_cast<int>(specs.size()), maxBlockSize);
+    stepIndices.resize(static_cast<size_t>(maxBlockSize));
+
+    for (size_t i = 0; i < stepIndices.size(); ++i)
+        stepIndices[i] = static_cast<float>(i + 1);
+
+    // Start settled at the current targets
+    for (size_t i = 0; i < specs.size(); ++i) {
+        auto& voice = voices[i];
+        voice.current = voice.target = targets[i].load();
+        voice.increment = 0.0f;
+        voice.stepsRemaining = 0;
+
+        juce::FloatVectorOperations::fill(ramps.getWritePointer(static_cast<int>(i)), voice.current, maxBlockSize);
+    }
+
+    ramping = {};
+    changedMask = {};
+}
+
+void ParameterBank::setTarget(size_t index, float value)
+{
+    jassert(index < specs.size());
+
+    auto const& spec = specs[index];
+    targets[index].store(juce::jlimit(spec.minValue, spec.maxValue, value), std::memory_order_relaxed);
+
+    setBit(dirty.data(), index);
+    setBit(uiDirty.data(), index);
+}
+
+ParameterBank::Mask ParameterBank::takeUiChanges()
+{
+    Mask result {};
+
+    for (size_t w = 0; w < result.size(); ++w)
+        result[w] = uiDirty[w].exchange(0, std::memory_order_acq_rel);
+
+    return result;
+}
+
+void ParameterBank::setBit(std::atomic<uint64_t>* words, size_t index)
+{
+    words[index / 64].fetch_or(uint64_t(1) << (index % 64), std::memory_order_release);
+}
+
+//==============================================================================
+void ParameterBank::process(int numSamples)
+{
+    jassert(numSamples <= maxBlockSize);
+    numSamples = std::min(numSamples, maxBlockSize);
+
+    if (numSamples <= 0)
+        return;
+
+    for (size_t w = 0; w < changedMask.size(); ++w)
+    {
+        // A voice that settled during the previous block still has ramp values in
+        // the head of its buffer; flatten it once so it can be skipped from now on.
+        forEachSetBit(changedMask[w] & ~ramping[w], w, [&](size_t i) {
+            juce::FloatVectorOperations::fill(ramps.getWritePointer(static_cast<int>(i)), voices[i].current, maxBlockSize);
+        });
+
+        changedMask[w] = 0;
+
+        // Start (or retarget) a ramp for everything written since the last block
+        forEachSetBit(dirty[w].exchange(0, std::memory_order_acquire), w, [&](size_t i) {
+            auto& voice = voices[i];
+            auto target = targets[i].load(std::memory_order_relaxed);
+
+            if (target == voice.target && voice.stepsRemaining == 0)
+                return;
+
+            voice.target = target;
+            voice.stepsRemaining = smoothingSamples;
+            voice.increment = (target - voice.current) / static_cast<float>(smoothingSamples);
+            ramping[w] |= uint64_t(1) << (i % 64);
+        });
+
+        forEachSetBit(ramping[w], w, [&](size_t i) {
+            auto& voice = voices[i];
+            auto* dest = ramps.getWritePointer(static_cast<int>(i));
+            auto n = std::min(voice.stepsRemaining, numSamples);
+
+            // dest[k] = current + increment * (k + 1)
+            juce::FloatVectorOperations::copyWithMultiply(dest, stepIndices.data(), voice.increment, n);
+            juce::FloatVectorOperations::add(dest, voice.current, n);
+
+            voice.stepsRemaining -= n;
+
+            if (voice.stepsRemaining == 0) {
+                voice.current = voice.target;
+                juce::FloatVectorOperations::fill(dest + n - 1, voice.target, numSamples - n + 1);
+                ramping[w] &= ~(uint64_t(1) << (i % 64));
+            } else {
+                voice.current = dest[n - 1];
+            }
+
+            changedMask[w] |= uint64_t(1) << (i % 64);
+        });
+    }
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+//==============================================================================
+// Lock-free storage and per-block smoothing for the plugin's parameters.
+//
+// Targets are written with setTarget() from any thread (host automation, the
+// WebView bridge) and only ever touch an atomic float plus a bit in a dirty mask.
+// Once per block the audio thread calls process(), which picks up new targets
+// and writes a sample-accurate linear ramp for every parameter that is still
+// moving, using JUCE's vectorised FloatVectorOperations. Parameters that are
+// neither dirty nor ramping are skipped entirely: their ramp buffer was filled
+// with the settled value once and simply stays valid.
+class ParameterBank
+{
+public:
+    //==============================================================================
+    static constexpr size_t kMaxParameters = 128;
+    using Mask = std::array<uint64_t, kMaxParameters / 64>;
+
+    struct Spec
+    {
+        std::string id;
+        std::string name;
+        float minValue = 0.0f;
+        float maxValue = 1.0f;
+        float defaultValue = 0.0f;
+    };
+
+    //==============================================================================
+    explicit ParameterBank(std::vector<Spec> specs);
+
+    //==============================================================================
+    size_t size() const { return specs.size(); }
+    Spec const& getSpec(size_t index) const { return specs[index]; }
+    int indexOf(std::string const& id) const;
+
+    //==============================================================================
+    // Allocates the ramp buffers. Not real-time safe.
+    void prepare(double sampleRate, int maxBlockSize, double smoothingSeconds = 0.02);
+
+    // Safe from any thread, including the audio thread.
+    void setTarget(size_t index, float value);
+    float getTarget(size_t index) const { return targets[index].load(std::memory_order_relaxed); }
+
+    // Returns and clears the set of parameters whose target changed since the
+    // last call; used to push updates to the UI.
+    Mask takeUiChanges();
+
+    //==============================================================================
+    // Audio thread: advances all ramps by numSamples (at most the prepared block
+    // size). Afterwards getRamp() holds numSamples values for every parameter, and
+    // getChangedMask() tells which of them differ from the previous block's end.
+    void process(int numSamples);
+
+    const float* getRamp(size_t index) const { return ramps.getReadPointer(static_cast<int>(index)); }
+    float getCurrentValue(size_t index) const { return voices[index].current; }
+    bool hasChanged(size_t index) const { return (changedMask[index / 64] >> (index % 64)) & 1; }
+    Mask const& getChangedMask() const { return changedMask; }
+
+private:
+    //==============================================================================
+    struct Voice
+    {
+        float current = 0.0f;
+        float target = 0.0f;
+        float increment = 0.0f;
+        int stepsRemaining = 0;
+    };
+
+    static void setBit(std::atomic<uint64_t>* words, size_t index);
+
+    //==============================================================================
+    std::vector<Spec> specs;
+    std::unique_ptr<std::atomic<float>[]> targets;
+
+    std::array<std::atomic<uint64_t>, kMaxParameters / 64> dirty {};
+    std::array<std::atomic<uint64_t>, kMaxParameters / 64> uiDirty {};
+
+    // Audio thread only
+    std::vector<Voice> voices;
+    Mask ramping {};
+    Mask changedMask {};
+    juce::AudioBuffer<float> ramps;
+    std::vector<float> stepIndices;   // 1, 2, 3, ... for building ramps
+    int maxBlockSize = 0;
+    int smoothingSamples = 1;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ParameterBank)
+};
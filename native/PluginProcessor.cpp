@@ -1,10 +1,14 @@
 #include "PluginProcessor.h"
-#include "WebViewEditor.h"
-#include <choc_javascript_QuickJS.h>
+#if ! ELEM_HEADLESS
+ #include "WebViewEditor.h"
+#endif
+#include "PluginState.h"
+#include "ScriptBytecode.h"
+#include "Trace.h"
 
 //==============================================================================
 // A quick helper for locating bundled asset files
-juce::File getAssetsDirectory()
+juce::File EffectsPluginProcessor::getAssetsDirectory()
 {
 #if JUCE_MAC
     auto assetsDir = juce::File::getSpecialLocation(juce::File::SpecialLocationType::currentApplicationFile)
@@ -15,30 +19,134 @@ juce::File getAssetsDirectory()
         .getParentDirectory()  // Plugin.vst3/Contents/
         .getChildFile("Resources/dist");
 #else
-#error "We only support Mac and Windows here yet."
+    // Headless builds: next to the executable, unless overridden
+    auto assetsDir = juce::File::getSpecialLocation(juce::File::SpecialLocationType::currentExecutableFile)
+        .getParentDirectory()
+        .getChildFile("dist");
+
+    auto assetsOverride = juce::SystemStats::getEnvironmentVariable("ELEM_ASSETS_DIR", {});
+
+    if (assetsOverride.isNotEmpty())
+        assetsDir = juce::File(assetsOverride);
 #endif
 
     return assetsDir;
 }
 
+// Converts the choc values QuickJS hands us into the elem::js values the runtime
+// consumes, without a detour through JSON.
+static elem::js::Value elemValueFromChocValue(choc::value::ValueView const& v)
+{
+    if (v.isVoid())
+        return {};
+
+    if (v.isBool())
+        return elem::js::Value(v.getBool());
+
+    if (v.isInt32() || v.isInt64() || v.isFloat32() || v.isFloat64())
+        return elem::js::Value(v.isFloat32() ? (double) v.getFloat32()
+                             : v.isFloat64() ? v.getFloat64()
+                             : v.isInt32() ? (double) v.getInt32()
+                             : (double) v.getInt64());
+
+    if (v.isString())
+        return elem::js::Value(std::string(v.getString()));
+
+    if (v.isArray() || v.isVector()) {
+        elem::js::Array result;
+        result.reserve(v.size());
+
+        for (uint32_t i = 0; i < v.size(); ++i)
+            result.push_back(elemValueFromChocValue(v[i]));
+
+        return elem::js::Value(result);
+    }
+
+    if (v.isObject()) {
+        elem::js::Object result;
+
+        for (uint32_t i = 0; i < v.size(); ++i) {
+            auto member = v.getObjectMemberAt(i);
+            result.insert({ std::string(member.name), elemValueFromChocValue(member.value) });
+        }
+
+        return elem::js::Value(result);
+    }
+
+    return {};
+}
+
+// The plugin's parameters, in host order; the position is also the index used by
+// the parameter bank.
+enum ParameterIndex : size_t
+{
+    kGainParam,
+    kPanParam,
+    kDriveParam,
+    kToneParam,
+    kMixParam,
+};
+
+static std::vector<ParameterBank::Spec> createParameterSpecs()
+{
+    return {
+        { "gain", "Gain", 0.0f, 2.0f, 1.0f },
+        { "pan", "Pan", -1.0f, 1.0f, 0.0f },
+        { "drive", "Drive", 0.0f, 1.0f, 0.0f },
+        { "tone", "Tone", 200.0f, 20000.0f, 20000.0f },
+        { "mix", "Mix", 0.0f, 1.0f, 0.0f },
+    };
+}
+
+//==============================================================================
 void EffectsPluginProcessor::getStateInformation(juce::MemoryBlock& destData)
 {
-    juce::XmlElement xml("MYPLUGINSETTINGS");
+    PluginState::Contents state;
+    state.cursor = chatHub->getCursor();
 
-    // Store any necessary state information here
+    chatHub->withHistory([&](ChatHistoryStore const& history) {
+        std::vector<ChatHistoryStore::Entry> entries;
+        history.getMessages(0, PluginState::kMaxHistoryMessages, entries);
 
-    copyXmlToBinary(xml, destData);
+        for (auto const& entry : entries)
+            state.history.emplace_back(entry.message);
+    });
+
+    for (size_t i = 0; i < hostParameters.size(); ++i)
+        state.parameters.push_back({ parameters.getSpec(i).id, hostParameters[i]->get() });
+
+    state.outbox = chatHub->getOutbox().getPending();
+
+    PluginState::write(state, destData);
 }
 
 void EffectsPluginProcessor::setStateInformation(const void* data, int sizeInBytes)
 {
-    std::unique_ptr<juce::XmlElement> xmlState(getXmlFromBinary(data, sizeInBytes));
-
-    if (xmlState != nullptr)
-    {
-        if (xmlState->hasTagName("MYPLUGINSETTINGS"))
-        {
-            // Retrieve any necessary state information here
+    PluginState::Contents state;
+
+    // Earlier versions saved an empty XML element here, which carries nothing to
+    // restore and is simply ignored.
+    if (!PluginState::read(data, static_cast<size_t>(sizeInBytes), state))
+        return;
+
+    // Shared by every instance, so this only seeds a hub that has no history yet.
+    // It is shown by the editor when it next reports "ready".
+    chatHub->restore(state.cursor, state.history);
+
+    // Unsent messages are queued again; ones the hub already has are skipped.
+    // The outbox lives on the message thread.
+    juce::MessageManager::callAsync([this, flag = alive, outbox = std::move(state.outbox)] {
+        if (flag->load())
+            chatHub->getOutbox().restore(outbox);
+    });
+
+    // Unknown ids belong to parameters that no longer exist and are skipped
+    for (auto const& [paramId, value] : state.parameters) {
+        auto index = parameters.indexOf(paramId);
+
+        if (index >= 0) {
+            auto* param = hostParameters[static_cast<size_t>(index)];
+            param->setValueNotifyingHost(param->convertTo0to1(value));
         }
     }
 }
@@ -49,57 +157,158 @@ EffectsPluginProcessor::EffectsPluginProcessor()
     : AudioProcessor(BusesProperties()
                       .withInput("Input", juce::AudioChannelSet::stereo(), true)
                       .withOutput("Output", juce::AudioChannelSet::stereo(), true)),
-      jsContext(choc::javascript::createQuickJSContext())
+      parameters(createParameterSpecs()),
+      alive(std::make_shared<std::atomic<bool>>(true)),
+      logs([this](std::string script) {
+          evaluateInEditor(std::move(script));
+      }),
+      delivery([this](std::string const& script) {
+          return evaluateInEditorNow(script);
+      }),
+      scheduler([this] {
+          return blockTimer.getRecentLoad();
+      })
 {
     // Minimal and safe operations in the constructor
+    for (size_t i = 0; i < parameters.size(); ++i) {
+        auto const& spec = parameters.getSpec(i);
+        auto* param = new juce::AudioParameterFloat(juce::ParameterID { spec.id, 1 }, spec.name, spec.minValue, spec.maxValue, spec.defaultValue);
+
+        param->addListener(this);
+        hostParameters.push_back(param);
+        addParameter(param);
+    }
+
+    scheduler.addTask("chatDelivery", BackgroundScheduler::Priority::normal, BackgroundScheduler::kTickMs, [this] {
+        delivery.service();
+    });
+
+    // Pushes parameter changes (host automation included) to the knobs
+    scheduler.addTask("parameterValues", BackgroundScheduler::Priority::normal, 33, [this] {
+        sendParameterValues(true);
+    });
+
+    // Collecting the script's garbage can always wait
+    scheduler.addTask("scriptIdleCollection", BackgroundScheduler::Priority::background, 500, [this] {
+        jsWorker.collectGarbageIfIdle();
+    });
+
+    scheduler.setModeListener([this](BackgroundScheduler::Mode mode) {
+        applySchedulerMode(mode);
+    });
+
+    auto logFile = juce::SystemStats::getEnvironmentVariable("ELEM_LOG_FILE", {});
+
+    if (logFile.isNotEmpty())
+        logs.setLogFile(juce::File(logFile));
+
+    auto heapLimitMb = juce::SystemStats::getEnvironmentVariable("ELEM_JS_HEAP_LIMIT_MB", {});
+
+    if (heapLimitMb.isNotEmpty())
+        jsWorker.setMemoryLimit(static_cast<size_t>(std::max(0, heapLimitMb.getIntValue())) * 1024 * 1024);
 }
 
 void EffectsPluginProcessor::initialize() {
-    // Initialize JavaScript engine and message fetching in a separate method
+    // Hosts scan by instantiating every plugin, often in a separate process, and
+    // load projects by instantiating dozens at once, so nothing expensive is
+    // started here. See activate().
+    scanOnly = isPluginScanProcess();
+}
+
+void EffectsPluginProcessor::activate() {
+    jassert(juce::MessageManager::existsAndIsCurrentThread());
+
     try {
-        initJavaScriptEngine();
         startFetchingMessages();
+
+        // Until prepareToPlay there is no runtime for the script to render into
+        if (runtime != nullptr && scriptNeedsLoad.exchange(false)) {
+            initJavaScriptEngine();
+            dispatchStateChange();
+        }
     } catch (const std::exception& e) {
-        DBG("Initialization error: " << e.what());
+        DBG("Activation error: " << e.what());
     } catch (...) {
-        DBG("Unknown exception during initialization");
+        DBG("Unknown exception during activation");
     }
 }
 
+bool EffectsPluginProcessor::isPluginScanProcess() {
+    auto forced = juce::SystemStats::getEnvironmentVariable("ELEM_SCAN_MODE", {});
+
+    if (forced.isNotEmpty())
+        return forced.getIntValue() != 0;
+
+    // Scanner and validator processes, e.g. "Ableton Plugin Scanner", auval,
+    // pluginval, "vst3scanner"
+    static bool const scanning = [] {
+        auto const host = juce::File::getSpecialLocation(juce::File::hostApplicationPath)
+                              .getFileNameWithoutExtension().toLowerCase().removeCharacters(" _-");
+
+        for (auto const* marker : { "scan", "auval", "pluginval", "validat", "inspector" })
+            if (host.contains(marker))
+                return true;
+
+        return false;
+    }();
+
+    return scanning;
+}
+
 //==============================================================================
 // Destructor
 EffectsPluginProcessor::~EffectsPluginProcessor()
 {
-    stopFetchingMessages();  // Ensure all message fetching is ceased
+    // The script's native callbacks reach into this processor, so the worker is
+    // joined before anything else goes away.
+    alive->store(false);
+    jsWorker.stop();
+#if ! ELEM_HEADLESS
+    warmWebView.reset();
+#endif
+
+    stopFetchingMessages();  // Unsubscribe from the shared chat hub
+
+    for (auto* param : hostParameters)
+        param->removeListener(this);
 }
 
 //==============================================================================
 // JavaScript engine initialization
+//
+// The context lives on the JavaScriptWorker thread; this only queues its
+// replacement. The native functions below are therefore called on the worker,
+// and anything touching the editor goes through evaluateInEditor().
 void EffectsPluginProcessor::initJavaScriptEngine()
 {
-    try {
-        jsContext = choc::javascript::createQuickJSContext();
+    jsWorker.restart([this](choc::javascript::Context& ctx) {
+        setupJavaScriptContext(ctx);
+    });
+}
 
+void EffectsPluginProcessor::setupJavaScriptContext(choc::javascript::Context& ctx)
+{
+    try {
         // Install native interop functions in our JavaScript environment
-        jsContext.registerFunction("__postNativeMessage__", [this](choc::javascript::ArgumentList args) {
+        ctx.registerFunction("__postNativeMessage__", [this](choc::javascript::ArgumentList args) {
+            ELEM_TRACE_SPAN("bridge", "bridge.postNativeMessage");
+
             try {
-                if (args.size() > 1 && args[0]->isString() && args[1]->isString()) {
+                if (args.size() > 1 && args[0]->isString() && !args[1]->isString()) {
+                    auto eventName = args[0]->getString();
+
+                    // The Elementary renderer posts its instruction batches as
+                    // plain arrays rather than strings.
+                    if (eventName == "renderInstructions") {
+                        applyRenderInstructions(*args[1]);
+                    }
+                } else if (args.size() > 1 && args[0]->isString() && args[1]->isString()) {
                     auto eventName = args[0]->getString();
                     auto eventData = args[1]->getString();
 
                     if (eventName == "sendMessage") {
-                        auto editor = dynamic_cast<WebViewEditor*>(getActiveEditor());
-                        if (editor) {
-                            auto webView = editor->getWebViewPtr();
-                            if (webView) {
-                                auto eventDataValue = choc::value::createString(eventData);
-                                webView->evaluateJavascript("globalThis.__sendMessage__(" + choc::json::toString(eventDataValue) + ")");
-                            } else {
-                                DBG("WebView pointer is null");
-                            }
-                        } else {
-                            DBG("Editor is not a WebViewEditor");
-                        }
+                        auto eventDataValue = choc::value::createString(eventData);
+                        evaluateInEditor("globalThis.__sendMessage__(" + choc::json::toString(eventDataValue) + ")");
                     }
                 }
             } catch (const std::exception& e) {
@@ -111,29 +320,31 @@ void EffectsPluginProcessor::initJavaScriptEngine()
             return choc::value::Value();
         });
 
-        jsContext.registerFunction("__log__", [this](choc::javascript::ArgumentList args) {
-            const auto* kDispatchScript = R"script(
-(function() {
-  console.log(...JSON.parse(%));
-  return true;
-})();
-)script";
+        ctx.registerFunction("__log__", [this](choc::javascript::ArgumentList args) {
+            // Nothing is formatted while there is no editor or log file to show it
+            if (!logs.isActive() || args.numArgs < 1 || !args[0]->isString())
+                return choc::value::Value();
 
             try {
-                if (auto* editor = static_cast<WebViewEditor*>(getActiveEditor())) {
-                    auto v = choc::value::createEmptyArray();
-
-                    for (size_t i = 0; i < args.numArgs; ++i) {
-                        v.addArrayElement(*args[i]);
-                    }
-
-                    auto expr = juce::String(kDispatchScript).replace("%", choc::json::toString(v)).toStdString();
-                    editor->getWebViewPtr()->evaluateJavascript(expr);
-                } else {
-                    for (size_t i = 0; i < args.numArgs; ++i) {
-                        DBG(choc::json::toString(*args[i]));
-                    }
+                auto const levelName = args[0]->getString();
+                auto const level = levelName == "error" ? LogChannel::Level::error
+                                 : levelName == "warn" ? LogChannel::Level::warning
+                                 : levelName == "debug" ? LogChannel::Level::debug
+                                 : LogChannel::Level::info;
+
+                logLine.clear();
+
+                for (size_t i = 1; i < args.numArgs; ++i) {
+                    if (i > 1)
+                        logLine += ' ';
+
+                    if (args[i]->isString())
+                        logLine += args[i]->getString();
+                    else
+                        logLine += choc::json::toString(*args[i]);
                 }
+
+                logs.write(level, logLine);
             } catch (const std::exception& e) {
                 DBG("Exception in __log__: " << e.what());
             } catch (...) {
@@ -143,55 +354,56 @@ void EffectsPluginProcessor::initJavaScriptEngine()
             return choc::value::Value();
         });
 
-        jsContext.registerFunction("__sendMessage__", [this](choc::javascript::ArgumentList args) {
-            try {
-                if (args.size() > 0 && args[0]->isString()) {
-                    auto serializedMessage = args[0]->getString();
-                    auto messageJson = juce::JSON::parse(juce::String(serializedMessage.data(), serializedMessage.length()));
+        ctx.registerFunction("__sendMessage__", [this](choc::javascript::ArgumentList args) {
+            if (args.size() > 0 && args[0]->isString()) {
+                // The outbox lives on the message thread
+                juce::MessageManager::callAsync([this, flag = alive, serialized = std::string(args[0]->getString())] {
+                    if (flag->load())
+                        sendSerializedMessage(serialized);
+                });
+            }
 
-                    if (messageJson.isObject()) {
-                        auto message = messageJson.getProperty("message", "").toString().toStdString();
-                        auto username = messageJson.getProperty("username", "").toString().toStdString();
+            return choc::value::Value();
+        });
 
-                        sendMessageToAPI(username, message);
-                    }
-                }
-            } catch (const std::exception& e) {
-                DBG("Exception in __sendMessage__: " << e.what());
-            } catch (...) {
-                DBG("Unknown exception in __sendMessage__");
-            }
+        // Lets the script watch its own footprint. A collection requested here
+        // runs after the current job rather than inside it.
+        ctx.registerFunction("__getMemoryStats__", [this](choc::javascript::ArgumentList) {
+            auto const json = juce::JSON::toString(JavaScriptWorker::toVar(jsWorker.getStats()), true);
+            return choc::json::parse(json.toStdString());
+        });
 
+        ctx.registerFunction("__collectGarbage__", [this](choc::javascript::ArgumentList) {
+            jsWorker.collectGarbage();
             return choc::value::Value();
         });
 
         // A simple shim to write various console operations to our native __log__ handler
-        jsContext.evaluate(R"shim(
+        ctx.evaluate(R"shim(
 (function() {
   if (typeof globalThis.console === 'undefined') {
     globalThis.console = {
       log(...args) {
-        __log__('[embedded:log]', ...args);
+        __log__('log', ...args);
+      },
+      info(...args) {
+        __log__('log', ...args);
+      },
+      debug(...args) {
+        __log__('debug', ...args);
       },
       warn(...args) {
-          __log__('[embedded:warn]', ...args);
+        __log__('warn', ...args);
       },
       error(...args) {
-          __log__('[embedded:error]', ...args);
+        __log__('error', ...args);
       }
     };
   }
 })();
         )shim");
 
-        // Load and evaluate the main.js script
-        auto chatScriptFile = getAssetsDirectory().getChildFile("main.js");
-        if (chatScriptFile.existsAsFile()) {
-            auto chatScriptContents = chatScriptFile.loadFileAsString().toStdString();
-            jsContext.evaluate(chatScriptContents);
-        } else {
-            DBG("main.js file does not exist");
-        }
+        loadDspScript(ctx);
     } catch (const std::exception& e) {
         DBG("Exception in initJavaScriptEngine: " << e.what());
     } catch (...) {
@@ -199,111 +411,119 @@ void EffectsPluginProcessor::initJavaScriptEngine()
     }
 }
 
-//==============================================================================
-// Message sending and fetching
-void EffectsPluginProcessor::sendMessageToAPI(const std::string& nickname, const std::string& message) {
-    try {
-        juce::URL url(apiSendEndpoint);
-
-        // Create postData object
-        auto postData = std::make_unique<juce::DynamicObject>();
-        postData->setProperty("nickname", juce::String(nickname));
-        postData->setProperty("message", juce::String(message));
-
-        // Convert postData to JSON string
-        juce::var jsonVar(postData.get());
-        juce::String jsonString = juce::JSON::toString(jsonVar);
-
-        // Prepare the InputStreamOptions
-        auto options = juce::URL::InputStreamOptions(juce::URL::ParameterHandling::inPostData)
-                       .withExtraHeaders("Content-Type: application/json")
-                       .withConnectionTimeoutMs(10000)
-                       .withHttpRequestCmd("POST");
-
-        // Create the input stream with post data
-        auto stream = url.createInputStream(options);
-
-        if (stream != nullptr) {
-            // Process the response synchronously
-            auto responseBody = stream->readEntireStreamAsString();
-            auto responseJson = juce::JSON::parse(responseBody);
-
-            if (responseJson.isObject()) {
-                auto messagesArray = responseJson.getProperty("messages", juce::var()).getArray();
-                if (messagesArray != nullptr && messagesArray->size() > 0) {
-                    lastMessageTimestamp = messagesArray->getReference(messagesArray->size() - 1).getProperty("createdAt", 0);
-                    for (auto& messageVar : *messagesArray) {
-                        auto messageJson = juce::JSON::toString(messageVar);
-                        handleChatMessage(messageJson.toStdString());
-                    }
-                }
-            }
+// Evaluates the bundled dsp/main.js (see the build-dsp script). The build also
+// leaves precompiled bytecode next to it, which skips parsing and compiling the
+// source; it is used only if it was compiled from the script now on disk.
+void EffectsPluginProcessor::loadDspScript(choc::javascript::Context& ctx)
+{
+    auto const startTicks = juce::Time::getHighResolutionTicks();
+    auto const assetsDir = getAssetsDirectory();
+    auto scriptFile = assetsDir.getChildFile("dsp.main.js");
+
+    if (!scriptFile.existsAsFile()) {
+        DBG("dsp.main.js file does not exist");
+        return;
+    }
+
+    auto source = scriptFile.loadFileAsString().toStdString();
+    bool usedBytecode = false;
+
+    juce::MemoryBlock bytecodeFile;
+
+    if (assetsDir.getChildFile("dsp.main.qjsbc").loadFileAsData(bytecodeFile)) {
+        const uint8_t* bytecode = nullptr;
+        size_t bytecodeSize = 0;
+
+        if (ScriptBytecode::unwrap(static_cast<const uint8_t*>(bytecodeFile.getData()), bytecodeFile.getSize(),
+                                   ScriptBytecode::hashSource(source), bytecode, bytecodeSize)) {
+            usedBytecode = jsWorker.evaluateBytecode(bytecode, bytecodeSize);
         } else {
-            DBG("Failed to create input stream for sendMessageToAPI");
+            DBG("dsp.main.qjsbc is stale or unreadable; compiling dsp.main.js");
         }
-    } catch (const std::exception& e) {
-        DBG("Exception in sendMessageToAPI: " << e.what());
-    } catch (...) {
-        DBG("Unknown exception in sendMessageToAPI");
     }
+
+    if (!usedBytecode)
+        ctx.evaluate(source);
+
+    DBG("Loaded dsp.main.js from " << (usedBytecode ? "bytecode" : "source") << " in "
+        << juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) * 1000.0 << " ms");
 }
 
-void EffectsPluginProcessor::fetchNewMessages()
-{
+//==============================================================================
+// Message sending and fetching
+//
+// The connection, cursor and history belong to the process-wide ChatHub; this
+// instance only subscribes to it and forwards new messages to its editor.
+void EffectsPluginProcessor::sendMessageToAPI(const std::string& nickname, const std::string& message) {
+    chatHub->sendMessage(nickname, message);
+}
+
+// Takes the {"message", "username"} JSON that the editor and the script send.
+void EffectsPluginProcessor::sendSerializedMessage(std::string_view serializedMessage) {
     try {
-        DBG("Entering fetchNewMessages");
-
-        juce::URL url(apiGetEndpoint);
-
-        // Create postData object
-        auto postData = std::make_unique<juce::DynamicObject>();
-        postData->setProperty("fromTimestamp", lastMessageTimestamp);
-
-        // Convert postData to JSON string
-        juce::var jsonVar(postData.get());
-        juce::String jsonString = juce::JSON::toString(jsonVar);
-
-        // Prepare the InputStreamOptions
-        auto options = juce::URL::InputStreamOptions(juce::URL::ParameterHandling::inPostData)
-                       .withExtraHeaders("Content-Type: application/json")
-                       .withConnectionTimeoutMs(10000)
-                       .withHttpRequestCmd("POST");
-
-        // Create the input stream with post data
-        auto stream = url.createInputStream(options);
-
-        if (stream != nullptr) {
-            // Process the response synchronously
-            auto responseBody = stream->readEntireStreamAsString();
-            auto responseJson = juce::JSON::parse(responseBody);
-
-            if (responseJson.isObject()) {
-                auto messagesArray = responseJson.getProperty("messages", juce::var()).getArray();
-                if (messagesArray != nullptr && messagesArray->size() > 0) {
-                    lastMessageTimestamp = messagesArray->getReference(messagesArray->size() - 1).getProperty("createdAt", 0);
-                    for (auto& messageVar : *messagesArray) {
-                        auto messageJson = juce::JSON::toString(messageVar);
-                        handleChatMessage(messageJson.toStdString());
-                    }
-                }
-            } else {
-                DBG("Response JSON is not an object");
-            }
-        } else {
-            DBG("Failed to create input stream for fetchNewMessages");
+        auto messageJson = juce::JSON::parse(juce::String::fromUTF8(serializedMessage.data(), static_cast<int>(serializedMessage.size())));
+
+        if (messageJson.isObject()) {
+            auto message = messageJson.getProperty("message", "").toString().toStdString();
+            auto username = messageJson.getProperty("username", "").toString().toStdString();
+
+            if (!message.empty())
+                sendMessageToAPI(username, message);
         }
     } catch (const std::exception& e) {
-        DBG("Exception in fetchNewMessages: " << e.what());
+        DBG("Exception in sendSerializedMessage: " << e.what());
     } catch (...) {
-        DBG("Unknown exception in fetchNewMessages");
+        DBG("Unknown exception in sendSerializedMessage");
     }
+}
 
-    DBG("Exiting fetchNewMessages");
+void EffectsPluginProcessor::fetchNewMessages() {
+    chatHub->fetchNewMessages();
+}
+
+void EffectsPluginProcessor::chatMessagesReceived(std::shared_ptr<const ChatHub::Batch> const& batch) {
+    // Without a page to show them there is nothing to do; the hub's history is
+    // what a later editor gets.
+    if (!hasEditorView())
+        return;
+
+    // Delivered to the WebView in the next frame's batch
+    for (auto const& entry : *batch)
+        delivery.push(entry.json);
 }
 
 //==============================================================================
 // State dispatchers
+//
+// Both scripts run on the script worker and in the editor, queued through the
+// scheduler: repeated requests before its next tick collapse into one run.
+// The embedded engine has no timers, so the script never queues jobs of its
+// own; it only runs in reply to these, to its setup and to the editor.
 void EffectsPluginProcessor::dispatchStateChange() {
+    scheduler.post("stateChange", BackgroundScheduler::Priority::essential, [this] {
+        dispatchStateChangeNow();
+    });
+}
+
+// Runtime errors are reported from the script worker, so this may be called
+// off the message thread.
+void EffectsPluginProcessor::dispatchError(std::string const& name, std::string const& message) {
+    if (!juce::MessageManager::existsAndIsCurrentThread()) {
+        juce::MessageManager::callAsync([this, flag = alive, name, message] {
+            if (flag->load())
+                dispatchError(name, message);
+        });
+
+        return;
+    }
+
+    // Only an identical error is collapsed into a waiting one
+    scheduler.post("error:" + name + ":" + message, BackgroundScheduler::Priority::normal, [this, name, message] {
+        dispatchErrorNow(name, message);
+    });
+}
+
+void EffectsPluginProcessor::dispatchStateChangeNow() {
     const auto* kDispatchScript = R"script(
 (function() {
   if (typeof globalThis.__receiveStateChange__ !== 'function')
@@ -315,11 +535,8 @@ void EffectsPluginProcessor::dispatchStateChange() {
 )script";
 
     try {
-        if (auto* editor = static_cast<WebViewEditor*>(getActiveEditor())) {
-            editor->getWebViewPtr()->evaluateJavascript(kDispatchScript);
-        }
-
-        jsContext.evaluate(kDispatchScript);
+        evaluateInEditor(kDispatchScript);
+        jsWorker.evaluate(kDispatchScript);
     } catch (const std::exception& e) {
         DBG("Exception in dispatchStateChange: " << e.what());
     } catch (...) {
@@ -327,7 +544,7 @@ void EffectsPluginProcessor::dispatchStateChange() {
     }
 }
 
-void EffectsPluginProcessor::dispatchError(std::string const& name, std::string const& message) {
+void EffectsPluginProcessor::dispatchErrorNow(std::string const& name, std::string const& message) {
     const auto* kDispatchScript = R"script(
 (function() {
   if (typeof globalThis.__receiveError__ !== 'function')
@@ -346,11 +563,8 @@ void EffectsPluginProcessor::dispatchError(std::string const& name, std::string
         auto messageStr = juce::String(message);
         auto expr = juce::String(kDispatchScript).replace("@", juce::JSON::toString(nameStr)).replace("%", juce::JSON::toString(messageStr)).toStdString();
 
-        if (auto* editor = static_cast<WebViewEditor*>(getActiveEditor())) {
-            editor->getWebViewPtr()->evaluateJavascript(expr);
-        }
-
-        jsContext.evaluate(expr);
+        evaluateInEditor(expr);
+        jsWorker.evaluate(expr);
     } catch (const std::exception& e) {
         DBG("Exception in dispatchError: " << e.what());
     } catch (...) {
@@ -360,29 +574,11 @@ void EffectsPluginProcessor::dispatchError(std::string const& name, std::string
 
 void EffectsPluginProcessor::handleChatMessage(std::string_view message) {
     try {
-        auto messageJson = juce::JSON::parse(juce::String(message.data(), message.length()));
+        ChatMessageArena arena(message.size());
+        ChatMessage decoded;
 
-        if (messageJson.isObject()) {
-            auto sender = messageJson.getProperty("nickname", "").toString();
-            auto text = messageJson.getProperty("message", "").toString();
-            auto timestamp = messageJson.getProperty("createdAt", 0).toString();
-
-            auto messageObject = std::make_unique<juce::DynamicObject>();
-            messageObject->setProperty("sender", sender);
-            messageObject->setProperty("text", text);
-            messageObject->setProperty("timestamp", timestamp);
-
-            auto messageString = juce::JSON::toString(juce::var(messageObject.release()));
-
-            if (auto* editor = static_cast<WebViewEditor*>(getActiveEditor())) {
-                auto webView = editor->getWebViewPtr();
-                if (webView) {
-                    std::string jsCall = "globalThis.__receiveMessage__(" + messageString.toStdString() + ")";
-                    webView->evaluateJavascript(jsCall);
-                } else {
-                    DBG("WebView pointer is null in handleChatMessage");
-                }
-            }
+        if (ChatMessageDecoder::decodeMessage(message, arena, decoded)) {
+            chatHub->addLocalMessage(decoded);
         }
     } catch (const std::exception& e) {
         DBG("Exception in handleChatMessage: " << e.what());
@@ -391,18 +587,444 @@ void EffectsPluginProcessor::handleChatMessage(std::string_view message) {
     }
 }
 
+void EffectsPluginProcessor::acknowledgeDeliveredMessages() {
+    delivery.acknowledge();
+}
+
+void EffectsPluginProcessor::resetMessageDelivery() {
+    delivery.reset();
+}
+
+void EffectsPluginProcessor::sendMessagePage(uint64_t beforeSeq, size_t maxCount) {
+    if (!hasEditorView())
+        return;
+
+    std::string page = "(function() {\n"
+                       "  if (typeof globalThis.__receiveMessagePage__ !== 'function')\n"
+                       "    return false;\n\n"
+                       "  globalThis.__receiveMessagePage__({\"beforeSeq\":";
+    page += std::to_string(beforeSeq);
+    page += ",\"messages\":[";
+
+    bool hasMore = false;
+
+    chatHub->withHistory([&](ChatHistoryStore const& history) {
+        history.getMessages(beforeSeq, maxCount, pageEntries);
+
+        for (size_t i = 0; i < pageEntries.size(); ++i) {
+            if (i > 0)
+                page += ',';
+
+            appendChatMessageJson(page, pageEntries[i].message, pageEntries[i].seq);
+        }
+
+        hasMore = !pageEntries.empty() && pageEntries.front().seq > history.getFirstSeq();
+    });
+
+    page += "],\"hasMore\":";
+    page += hasMore ? "true" : "false";
+    page += "});\n  return true;\n})();\n";
+
+    evaluateInEditorNow(page);
+}
+
+// Answers a search from the editor, {id, text, nickname, from, to, limit}, with
+// the newest matches and per-sender counts.
+void EffectsPluginProcessor::searchMessages(std::string_view serializedQuery) {
+    if (!hasEditorView())
+        return;
+
+    ChatSearchIndex::Query query;
+    juce::var requestId;
+
+    try {
+        auto parsed = juce::JSON::parse(juce::String::fromUTF8(serializedQuery.data(), static_cast<int>(serializedQuery.size())));
+
+        if (!parsed.isObject()) {
+            DBG("searchMessages expects an object");
+            return;
+        }
+
+        requestId = parsed.getProperty("id", {});
+        query.text = parsed.getProperty("text", "").toString().toStdString();
+        query.nickname = parsed.getProperty("nickname", "").toString().toStdString();
+        query.fromTimestamp = static_cast<int64_t>(parsed.getProperty("from", 0));
+        query.toTimestamp = static_cast<int64_t>(parsed.getProperty("to", 0));
+        query.maxResults = static_cast<size_t>(juce::jlimit(0, 500, static_cast<int>(parsed.getProperty("limit", 50))));
+    } catch (const std::exception& e) {
+        DBG("Exception in searchMessages: " << e.what());
+        return;
+    } catch (...) {
+        DBG("Unknown exception in searchMessages");
+        return;
+    }
+
+    std::string response = "(function() {\n"
+                           "  if (typeof globalThis.__receiveSearchResults__ !== 'function')\n"
+                           "    return false;\n\n"
+                           "  globalThis.__receiveSearchResults__({\"id\":";
+    response += juce::JSON::toString(requestId, true).toStdString();
+    response += ",\"messages\":[";
+
+    auto const startTicks = juce::Time::getHighResolutionTicks();
+    double searchUs = 0.0;
+
+    chatHub->withSearchIndex([&](ChatSearchIndex const& index, ChatHistoryStore const& history) {
+        index.search(query, searchResult);
+        searchUs = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) * 1.0e6;
+
+        ChatHistoryStore::Entry entry;
+        bool first = true;
+
+        for (auto seq : searchResult.seqs) {
+            if (!history.getMessage(seq, entry))
+                continue;
+
+            if (!first)
+                response += ',';
+
+            appendChatMessageJson(response, entry.message, entry.seq);
+            first = false;
+        }
+
+        response += "],\"facets\":[";
+
+        for (size_t i = 0; i < searchResult.nicknameCounts.size(); ++i) {
+            if (i > 0)
+                response += ',';
+
+            // The index keeps senders lowercased; this is what a facet filters on
+            auto const& [nickname, count] = searchResult.nicknameCounts[i];
+            response += "{\"nickname\":";
+            response += juce::JSON::toString(juce::String::fromUTF8(nickname.data(), static_cast<int>(nickname.size())), true).toStdString();
+            response += ",\"count\":" + std::to_string(count) + "}";
+        }
+    });
+
+    response += "],\"total\":" + std::to_string(searchResult.totalMatches);
+    response += ",\"exact\":";
+    response += searchResult.totalIsExact ? "true" : "false";
+    response += ",\"elapsedUs\":" + std::to_string(searchUs);
+    response += "});\n  return true;\n})();\n";
+
+    evaluateInEditorNow(response);
+}
+
+//==============================================================================
+// Parameters
+//
+// Every change, whether from host automation or the editor, arrives through the
+// parameter listener and only stores a new target in the bank, so it is safe on
+// whichever thread the host calls it from.
+void EffectsPluginProcessor::parameterValueChanged(int parameterIndex, float newValue) {
+    if (parameterIndex < 0 || static_cast<size_t>(parameterIndex) >= hostParameters.size())
+        return;
+
+    auto index = static_cast<size_t>(parameterIndex);
+    parameters.setTarget(index, hostParameters[index]->convertFrom0to1(newValue));
+}
+
+void EffectsPluginProcessor::setParameterFromEditor(std::string const& paramId, double normalizedValue) {
+    auto index = parameters.indexOf(paramId);
+
+    if (index < 0) {
+        DBG("Unknown parameter " << juce::String(paramId));
+        return;
+    }
+
+    auto* param = hostParameters[static_cast<size_t>(index)];
+    param->beginChangeGesture();
+    param->setValueNotifyingHost(static_cast<float>(juce::jlimit(0.0, 1.0, normalizedValue)));
+    param->endChangeGesture();
+}
+
+void EffectsPluginProcessor::sendParameterValues(bool changedOnly) {
+    // Taken even without an editor so a later one does not replay stale changes
+    auto changed = parameters.takeUiChanges();
+
+    if (!hasEditorView())
+        return;
+
+    std::string values;
+
+    for (size_t i = 0; i < parameters.size(); ++i) {
+        if (changedOnly && ((changed[i / 64] >> (i % 64)) & 1) == 0)
+            continue;
+
+        values += values.empty() ? "{\"" : ",\"";
+        values += parameters.getSpec(i).id;
+        values += "\":";
+        values += juce::String(hostParameters[i]->convertTo0to1(parameters.getTarget(i))).toStdString();
+    }
+
+    if (values.empty())
+        return;
+
+    evaluateInEditorNow("(function() {\n"
+                        "  if (typeof globalThis.__receiveParameterValues__ !== 'function')\n"
+                        "    return false;\n\n"
+                        "  globalThis.__receiveParameterValues__(" + values + "});\n"
+                        "  return true;\n"
+                        "})();\n");
+}
+
+void EffectsPluginProcessor::sendPerformanceStats() {
+    scheduler.post("performanceStats", BackgroundScheduler::Priority::normal, [this] {
+        sendPerformanceStatsNow();
+    });
+}
+
+// Polled by the editor's performance readout, along with the script engine's memory
+// and the scheduler's state
+void EffectsPluginProcessor::sendPerformanceStatsNow() {
+    if (!hasEditorView())
+        return;
+
+    auto timing = BlockTimer::toVar(blockTimer.getStats());
+
+    if (auto* object = timing.getDynamicObject()) {
+        object->setProperty("javascript", JavaScriptWorker::toVar(jsWorker.getStats()));
+        object->setProperty("scheduler", BackgroundScheduler::toVar(scheduler.getStats()));
+    }
+
+    auto const stats = juce::JSON::toString(timing, true).toStdString();
+
+    evaluateInEditorNow("(function() {\n"
+                        "  if (typeof globalThis.__receivePerformanceStats__ !== 'function')\n"
+                        "    return false;\n\n"
+                        "  globalThis.__receivePerformanceStats__(" + stats + ");\n"
+                        "  return true;\n"
+                        "})();\n");
+}
+
+// Records the next few seconds of output and posts them to the chat as FLAC
+bool EffectsPluginProcessor::startAudioCapture(double seconds, std::string const& nickname) {
+    auto started = capture.start(seconds, [this, flag = alive, nickname](juce::MemoryBlock const& flac, double capturedSeconds) {
+        if (!flag->load())
+            return;
+
+        chatHub->sendAudioSnippet(nickname, flac, capturedSeconds);
+        sendCaptureState(false);
+    });
+
+    if (started)
+        sendCaptureState(true);
+
+    return started;
+}
+
+void EffectsPluginProcessor::startTracing() {
+    Trace::start();
+    sendTraceState({});
+}
+
+juce::File EffectsPluginProcessor::stopTracing() {
+    Trace::stop();
+
+    auto file = juce::File(juce::SystemStats::getEnvironmentVariable("ELEM_TRACE_FILE", {}));
+
+    if (file == juce::File())
+        file = juce::File::getSpecialLocation(juce::File::tempDirectory)
+                   .getChildFile("ostin-trace-" + juce::Time::getCurrentTime().formatted("%Y%m%d-%H%M%S") + ".json");
+
+    if (!Trace::writeChromeJson(file)) {
+        DBG("Could not write the trace to " << file.getFullPathName());
+        file = juce::File();
+    }
+
+    sendTraceState(file);
+    return file;
+}
+
+void EffectsPluginProcessor::sendTraceState(juce::File const& lastTrace) {
+    if (!hasEditorView())
+        return;
+
+    auto* state = new juce::DynamicObject();
+    state->setProperty("active", Trace::isEnabled());
+    state->setProperty("file", lastTrace.getFullPathName());
+
+    auto const json = juce::JSON::toString(juce::var(state), true).toStdString();
+
+    evaluateInEditorNow("(function() {\n"
+                        "  if (typeof globalThis.__receiveTraceState__ !== 'function')\n"
+                        "    return false;\n\n"
+                        "  globalThis.__receiveTraceState__(" + json + ");\n"
+                        "  return true;\n"
+                        "})();\n");
+}
+
+void EffectsPluginProcessor::sendCaptureState(bool capturing) {
+    if (!hasEditorView())
+        return;
+
+    evaluateInEditorNow("(function() {\n"
+                        "  if (typeof globalThis.__receiveCaptureState__ !== 'function')\n"
+                        "    return false;\n\n"
+                        "  globalThis.__receiveCaptureState__(" + std::string(capturing ? "true" : "false") + ");\n"
+                        "  return true;\n"
+                        "})();\n");
+}
+
+// Applies output gain and stereo balance. Settled parameters cost a scalar
+// multiply per channel (or nothing at unity); only a moving parameter is applied
+// per sample from its ramp.
+void EffectsPluginProcessor::applyOutputParameters(float* const* outputs, int numChannels, int numSamples) {
+    using FVO = juce::FloatVectorOperations;
+
+    auto const isStereo = numChannels == 2;
+    auto const moving = parameters.hasChanged(kGainParam) || (isStereo && parameters.hasChanged(kPanParam));
+
+    if (!moving) {
+        auto const gain = parameters.getCurrentValue(kGainParam);
+        auto const pan = isStereo ? parameters.getCurrentValue(kPanParam) : 0.0f;
+
+        for (int ch = 0; ch < numChannels; ++ch) {
+            auto const g = gain * std::min(1.0f, 1.0f + (ch == 0 ? -pan : pan));
+
+            if (g != 1.0f)
+                FVO::multiply(outputs[ch], g, numSamples);
+        }
+
+        return;
+    }
+
+    auto const* gainRamp = parameters.getRamp(kGainParam);
+
+    if (!isStereo) {
+        for (int ch = 0; ch < numChannels; ++ch)
+            FVO::multiply(outputs[ch], gainRamp, numSamples);
+
+        return;
+    }
+
+    auto const* panRamp = parameters.getRamp(kPanParam);
+    auto* g = channelGains.getWritePointer(0);
+
+    for (int ch = 0; ch < 2; ++ch) {
+        // g = gain * min(1, 1 -/+ pan)
+        FVO::copyWithMultiply(g, panRamp, ch == 0 ? -1.0f : 1.0f, numSamples);
+        FVO::add(g, 1.0f, numSamples);
+        FVO::min(g, g, 1.0f, numSamples);
+        FVO::multiply(g, gainRamp, numSamples);
+        FVO::multiply(outputs[ch], g, numSamples);
+    }
+}
+
+// Runs the script in the editor's WebView, if one is open. Safe from any thread;
+// off the message thread the call is posted there.
+void EffectsPluginProcessor::evaluateInEditor(std::string script) {
+    auto evaluate = [this, flag = alive, script = std::move(script)]() {
+        if (!flag->load())
+            return;
+
+        evaluateInEditorNow(script);
+    };
+
+    if (juce::MessageManager::existsAndIsCurrentThread())
+        evaluate();
+    else
+        juce::MessageManager::callAsync(std::move(evaluate));
+}
+
+// Message thread only. Returns false if there is no page to run the script in.
+bool EffectsPluginProcessor::evaluateInEditorNow(std::string const& script) {
+#if ELEM_HEADLESS
+    return headlessScriptSink != nullptr && headlessScriptSink(script);
+#else
+    if (auto* webView = getEditorWebView()) {
+        ELEM_TRACE_SPAN("webview", "webview.evaluateJavascript");
+        webView->evaluateJavascript(script);
+        return true;
+    }
+
+    return false;
+#endif
+}
+
+bool EffectsPluginProcessor::hasEditorView() {
+#if ELEM_HEADLESS
+    return headlessScriptSink != nullptr;
+#else
+    return getEditorWebView() != nullptr;
+#endif
+}
+
+#if ELEM_HEADLESS
+void EffectsPluginProcessor::setHeadlessScriptSink(std::function<bool(std::string const&)> sink) {
+    headlessScriptSink = std::move(sink);
+    logs.setForwardingToEditor(headlessScriptSink != nullptr);
+}
+#else
+choc::ui::WebView* EffectsPluginProcessor::getEditorWebView() {
+    if (auto* editor = dynamic_cast<WebViewEditor*>(getActiveEditor()))
+        return editor->getWebViewPtr();
+
+    return nullptr;
+}
+#endif
+
 //==============================================================================
 // Editor creation
+//
+// With keepWebViewWarm, an editor that closes hands its WebView back here instead
+// of destroying it, and the next editor re-attaches it. The page keeps its state
+// and skips the reload, React boot and "ready" round trip. While detached it
+// receives no deliveries; the newest page of history and the parameter values
+// are sent again when it is attached.
+void EffectsPluginProcessor::handleEditorReady() {
+    logs.setForwardingToEditor(true);
+
+    // Live messages queued for the previous page are superseded by the newest
+    // page of history
+    resetMessageDelivery();
+    sendMessagePage(0, 50);
+    sendParameterValues(false);
+    sendTraceState({});
+    dispatchStateChange();
+}
+
+void EffectsPluginProcessor::editorBeingDeleted(juce::AudioProcessorEditor* editor) {
+    logs.setForwardingToEditor(false);
+    AudioProcessor::editorBeingDeleted(editor);
+}
+
+#if ! ELEM_HEADLESS
+std::unique_ptr<choc::ui::WebView> EffectsPluginProcessor::takeWarmWebView() {
+    return std::move(warmWebView);
+}
+
+void EffectsPluginProcessor::retainWebView(std::unique_ptr<choc::ui::WebView> webView) {
+    if (keepWebViewWarm)
+        warmWebView = std::move(webView);
+}
+
+void EffectsPluginProcessor::setKeepWebViewWarm(bool shouldKeepWarm) {
+    keepWebViewWarm = shouldKeepWarm;
+
+    if (!keepWebViewWarm)
+        warmWebView.reset();
+}
+
 juce::AudioProcessorEditor* EffectsPluginProcessor::createEditor() {
+    // Nobody opens an editor during a scan
+    scanOnly = false;
+    activate();
+
     auto* editor = new WebViewEditor(this, getAssetsDirectory(), 2000, 500);
     if (!editor->getWebViewPtr()) {
         DBG("Failed to initialize WebViewEditor");
     }
     return editor;
 }
+#else
+juce::AudioProcessorEditor* EffectsPluginProcessor::createEditor() {
+    return nullptr;
+}
+#endif
 
 bool EffectsPluginProcessor::hasEditor() const {
-    return true;
+    return ! ELEM_HEADLESS;
 }
 
 //==============================================================================
@@ -440,31 +1062,192 @@ const juce::String EffectsPluginProcessor::getProgramName(int /* index */) { ret
 void EffectsPluginProcessor::changeProgramName(int /* index */, const juce::String& /* newName */) {}
 
 //==============================================================================
-// Timer control for fetching messages
+// Receive transport control
+//
+// Both settings belong to the shared hub and so apply to every instance.
+void EffectsPluginProcessor::setApiBaseUrl(std::string const& baseUrl) {
+    chatHub->setApiBaseUrl(baseUrl);
+}
+
+void EffectsPluginProcessor::setStreamingEnabled(bool shouldStream) {
+    chatHub->setStreamingEnabled(shouldStream);
+}
+
 void EffectsPluginProcessor::startFetchingMessages() {
-    startTimer(10000);  // Fetch messages every 10 seconds
+    if (!subscribedToChat) {
+        chatHub->addListener(this);
+        subscribedToChat = true;
+    }
+
+    scheduler.start();
 }
 
 void EffectsPluginProcessor::stopFetchingMessages() {
-    stopTimer();  // Stop the timer
+    scheduler.stop();
+
+    if (holdingChatFetches) {
+        chatHub->releaseFetches();
+        holdingChatFetches = false;
+    }
+
+    if (subscribedToChat) {
+        chatHub->removeListener(this);
+        subscribedToChat = false;
+    }
 }
 
-void EffectsPluginProcessor::timerCallback() {
-    fetchNewMessages();  // Fetch new messages every time the timer ticks
+//==============================================================================
+// Background work
+//
+// An offline render or high DSP load throttles everything the scheduler runs.
+// The chat poll is shared with the other instances and runs on the hub's own
+// timer, so this instance adds its hold for as long as it is not in normal
+// mode; the hub polls again once every instance has let go.
+void EffectsPluginProcessor::setNonRealtime(bool isNonRealtime) noexcept {
+    AudioProcessor::setNonRealtime(isNonRealtime);
+    scheduler.setRenderingOffline(isNonRealtime);
+}
+
+void EffectsPluginProcessor::applySchedulerMode(BackgroundScheduler::Mode mode) {
+    auto const shouldHold = mode != BackgroundScheduler::Mode::normal;
+
+    if (shouldHold != holdingChatFetches) {
+        if (shouldHold)
+            chatHub->holdFetches();
+        else
+            chatHub->releaseFetches();
+
+        holdingChatFetches = shouldHold;
+    }
+
+    Trace::instant("scheduler", BackgroundScheduler::toString(mode));
+}
+
+//==============================================================================
+// Elementary runtime
+//
+// applyInstructions() builds the new graph nodes on the calling (non-realtime)
+// thread and hands them to the audio thread through the runtime's own lock-free
+// queues, so process() never allocates or locks.
+void EffectsPluginProcessor::applyRenderInstructions(choc::value::ValueView const& batch) {
+    ELEM_TRACE_SPAN("elem", "elem.applyInstructions");
+    const juce::ScopedLock sl(runtimeLock);
+
+    // Before the first prepareToPlay there is nothing to render into; the graph is
+    // rendered again once the runtime exists.
+    if (runtime == nullptr)
+        return;
+
+    auto const instructions = elemValueFromChocValue(batch);
+
+    if (!instructions.isArray()) {
+        DBG("renderInstructions expects an array");
+        return;
+    }
+
+    auto rc = runtime->applyInstructions(instructions.getArray());
+
+    if (rc != elem::ReturnCode::Ok()) {
+        dispatchError("Runtime Error", elem::ReturnCode::describe(rc));
+    }
 }
 
 //==============================================================================
 // Audio Processing methods
 void EffectsPluginProcessor::prepareToPlay(double sampleRate, int samplesPerBlock) {
-    // Add any necessary preparation code here
+    auto const numChannels = std::max(getTotalNumInputChannels(), getTotalNumOutputChannels());
+
+    // Everything processBlock needs is allocated here, up front
+    scratchBuffer.setSize(numChannels, samplesPerBlock);
+    channelGains.setSize(1, samplesPerBlock);
+    parameters.prepare(sampleRate, samplesPerBlock);
+    blockTimer.prepare(sampleRate, samplesPerBlock);
+    effects.prepare(sampleRate, samplesPerBlock, numChannels);
+    capture.prepare(sampleRate, getTotalNumOutputChannels());
+
+    if (runtime == nullptr || lastKnownSampleRate != sampleRate || lastKnownBlockSize != samplesPerBlock) {
+        {
+            const juce::ScopedLock sl(runtimeLock);
+            runtime = std::make_unique<elem::Runtime<float>>(sampleRate, samplesPerBlock);
+        }
+
+        lastKnownSampleRate = sampleRate;
+        lastKnownBlockSize = samplesPerBlock;
+
+        // A fresh runtime has no graph; reload the script so it renders one
+        scriptNeedsLoad = true;
+    }
+
+    // A scanner may prepare and even process a block; it still gets no script
+    // or network.
+    if (scanOnly)
+        return;
+
+    if (juce::MessageManager::existsAndIsCurrentThread()) {
+        activate();
+    } else {
+        juce::MessageManager::callAsync([this, flag = alive] {
+            if (flag->load())
+                activate();
+        });
+    }
 }
 
 void EffectsPluginProcessor::releaseResources() {
-    // Add any necessary resource cleanup code here
+    // The runtime and scratch buffer are kept so a resume with the same
+    // configuration does not need to rebuild the graph
 }
 
-void EffectsPluginProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages) {
-    // Implement your audio processing logic here
+void EffectsPluginProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& /* midiMessages */) {
+    juce::ScopedNoDenormals noDenormals;
+
+    auto* rt = runtime.get();
+
+    if (rt == nullptr)
+        return;
+
+    ELEM_TRACE_SPAN("audio", "processBlock");
+    auto const blockStart = blockTimer.begin();
+    auto const numInputs = getTotalNumInputChannels();
+    auto const numOutputs = buffer.getNumChannels();
+    auto const numSamples = buffer.getNumSamples();
+    auto const maxBlock = scratchBuffer.getNumSamples();
+
+    // Some hosts deliver more than the announced block size; render in slices of
+    // at most that size rather than touching the allocator.
+    for (int offset = 0; offset < numSamples; offset += maxBlock) {
+        auto const n = std::min(maxBlock, numSamples - offset);
+
+        for (int ch = 0; ch < numInputs; ++ch)
+            scratchBuffer.copyFrom(ch, 0, buffer, ch, offset, n);
+
+        float* outputs[32];
+        auto const numOutputsUsed = std::min(numOutputs, (int) std::size(outputs));
+
+        for (int ch = 0; ch < numOutputsUsed; ++ch)
+            outputs[ch] = buffer.getWritePointer(ch, offset);
+
+        rt->process(
+            const_cast<const float**>(scratchBuffer.getArrayOfWritePointers()),
+            static_cast<size_t>(numInputs),
+            outputs,
+            static_cast<size_t>(numOutputsUsed),
+            static_cast<size_t>(n),
+            nullptr);
+
+        parameters.process(n);
+
+        effects.process(outputs, numOutputsUsed, n,
+                        parameters.getCurrentValue(kDriveParam),
+                        parameters.getCurrentValue(kToneParam),
+                        parameters.getCurrentValue(kMixParam),
+                        parameters.hasChanged(kMixParam) ? parameters.getRamp(kMixParam) : nullptr);
+
+        applyOutputParameters(outputs, numOutputsUsed, n);
+        capture.push(outputs, numOutputsUsed, n);
+    }
+
+    blockTimer.end(blockStart, numSamples);
 }
 
 //==============================================================================
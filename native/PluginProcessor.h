@@ -2,10 +2,26 @@
 #include <juce_audio_basics/juce_audio_basics.h>
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <choc_javascript.h>
+#include <elem/Runtime.h>
+
+#include "AudioCapture.h"
+#include "BackgroundScheduler.h"
+#include "BlockTimer.h"
+#include "ChatDeliveryQueue.h"
+#include "ChatHub.h"
+#include "ChatMessage.h"
+#include "EffectChain.h"
+#include "JavaScriptWorker.h"
+#include "LogChannel.h"
+#include "ParameterBank.h"
+
+namespace choc::ui { class WebView; }
 
 //==============================================================================
 class EffectsPluginProcessor
-    : public juce::AudioProcessor, public juce::Timer
+    : public juce::AudioProcessor,
+      private juce::AudioProcessorParameter::Listener,
+      private ChatHub::Listener
 {
 public:
     //==============================================================================
@@ -13,7 +29,20 @@ public:
     ~EffectsPluginProcessor() override;
 
     //==============================================================================
-    void initialize(); // Declare the initialize method here
+    // Construction and initialize() are cheap: no script, no network. The chat
+    // connection and the script engine come up in activate(), which the first
+    // prepareToPlay and opening the editor call for you. An instance created
+    // by a plugin scanner is never activated by prepareToPlay.
+    void initialize();
+    void activate();
+
+    // Forced by ELEM_SCAN_MODE=1 or 0, otherwise guessed from the host's name
+    static bool isPluginScanProcess();
+    void setScanOnly(bool shouldBeScanOnly) { scanOnly = shouldBeScanOnly; }
+    bool isScanOnly() const { return scanOnly; }
+
+    // The bundled dist/ folder: the editor's assets and dsp.main.js
+    static juce::File getAssetsDirectory();
 
     juce::AudioProcessorEditor* createEditor() override;
     bool hasEditor() const override;
@@ -34,25 +63,147 @@ public:
     void setStateInformation(const void* data, int sizeInBytes) override;
 
     void initJavaScriptEngine();
+    // Run from the scheduler. A state change re-renders the graph, so it is
+    // essential and goes ahead even during an offline render; an error waits.
     void dispatchStateChange();
     void dispatchError(std::string const& name, std::string const& message);
+    void applyRenderInstructions(choc::value::ValueView const& batch);
     void handleChatMessage(std::string_view message);
+    void acknowledgeDeliveredMessages();
+    void resetMessageDelivery();
+    void sendMessagePage(uint64_t beforeSeq, size_t maxCount);
+    void searchMessages(std::string_view serializedQuery);
     void sendMessageToAPI(const std::string& nickname, const std::string& message);
+    void sendSerializedMessage(std::string_view serializedMessage);
     void fetchNewMessages();
+    void setApiBaseUrl(std::string const& baseUrl);
+    void setStreamingEnabled(bool shouldStream);
+    void handleEditorReady();
+    void editorBeingDeleted(juce::AudioProcessorEditor* editor) override;
+#if ELEM_HEADLESS
+    // Stands in for the editor's WebView: receives every script that would be
+    // evaluated there and returns false to report "no editor".
+    void setHeadlessScriptSink(std::function<bool(std::string const&)> sink);
+#else
+    std::unique_ptr<choc::ui::WebView> takeWarmWebView();
+    void retainWebView(std::unique_ptr<choc::ui::WebView> webView);
+    void setKeepWebViewWarm(bool shouldKeepWarm);
+#endif
+    void setParameterFromEditor(std::string const& paramId, double normalizedValue);
+    void sendParameterValues(bool changedOnly);
+    // Answered from the scheduler, so not during an offline render
+    void sendPerformanceStats();
+    void resetPerformanceStats() { blockTimer.reset(); }
+    bool startAudioCapture(double seconds, std::string const& nickname);
+
+    // Tracing is process wide, so this starts or stops it for every instance.
+    // Stopping writes the session to ELEM_TRACE_FILE, or to a timestamped file
+    // in the temp directory, and returns that file.
+    void startTracing();
+    juce::File stopTracing();
+    void sendTraceState(juce::File const& lastTrace);
+    void sendCaptureState(bool capturing);
     void startFetchingMessages();
     void stopFetchingMessages();
-    void timerCallback() override;
+
+    JavaScriptWorker::Stats getJavaScriptStats() const { return jsWorker.getStats(); }
+    void setJavaScriptMemoryLimit(size_t bytes) { jsWorker.setMemoryLimit(bytes); }
+    void collectJavaScriptGarbage() { jsWorker.collectGarbage(); }
+    LogChannel::Stats getLogStats() const { return logs.getStats(); }
+    BlockTimer::Stats getBlockTimingStats() const { return blockTimer.getStats(); }
+    AudioCapture::Stats getCaptureStats() const { return capture.getStats(); }
+    ChatHub& getChatHub() { return *chatHub; }
+    BackgroundScheduler& getScheduler() { return scheduler; }
+
+    // Tells the scheduler, which holds back background work for the render
+    void setNonRealtime(bool isNonRealtime) noexcept override;
 
     void prepareToPlay(double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
     void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
 
 private:
-    choc::javascript::Context jsContext;
-    std::string apiBaseUrl = "http://ableton-chat-01-72c15f63599a.herokuapp.com";
-    std::string apiSendEndpoint = apiBaseUrl + "/messages/send";
-    std::string apiGetEndpoint = apiBaseUrl + "/messages/get";
-    int64_t lastMessageTimestamp = 0;
+    bool evaluateInEditorNow(std::string const& script);
+    bool hasEditorView();
+#if ! ELEM_HEADLESS
+    choc::ui::WebView* getEditorWebView();
+#endif
+    void evaluateInEditor(std::string script);
+    void sendPerformanceStatsNow();
+    void dispatchStateChangeNow();
+    void dispatchErrorNow(std::string const& name, std::string const& message);
+    void applySchedulerMode(BackgroundScheduler::Mode mode);
+    void setupJavaScriptContext(choc::javascript::Context& ctx);
+    void loadDspScript(choc::javascript::Context& ctx);
+    void applyOutputParameters(float* const* outputs, int numChannels, int numSamples);
+
+    void parameterValueChanged(int parameterIndex, float newValue) override;
+    void parameterGestureChanged(int, bool) override {}
+
+    void chatMessagesReceived(std::shared_ptr<const ChatHub::Batch> const& batch) override;
+
+    // Replaced only in prepareToPlay, which the host never runs concurrently with
+    // processBlock; runtimeLock keeps it stable for applyRenderInstructions.
+    std::unique_ptr<elem::Runtime<float>> runtime;
+    juce::CriticalSection runtimeLock;
+    juce::AudioBuffer<float> scratchBuffer;
+    double lastKnownSampleRate = 0.0;
+    int lastKnownBlockSize = 0;
+
+    // Set when the runtime is (re)created, cleared once the script is loading.
+    // Some hosts prepare off the message thread, where activate() runs.
+    std::atomic<bool> scriptNeedsLoad { false };
+    bool scanOnly = false;
+
+    // Host-facing parameters and their lock-free, smoothed mirror. Host automation
+    // and the editor both write through the AudioParameterFloat, whose listener
+    // forwards the new target to the bank.
+    ParameterBank parameters;
+    std::vector<juce::AudioParameterFloat*> hostParameters;
+    juce::AudioBuffer<float> channelGains;
+
+    // Tone, drive and mix, after the Elementary graph and before gain and pan
+    EffectChain effects;
+
+    // Cost of each processBlock against its real-time budget
+    BlockTimer blockTimer;
+
+    // Records the final output for sharing in the chat
+    AudioCapture capture;
+
+    // Shared with callbacks posted to the message thread; cleared in the destructor
+    std::shared_ptr<std::atomic<bool>> alive;
+
+    // Owns the embedded QuickJS context; stopped first in the destructor
+    JavaScriptWorker jsWorker;
+
+    // The script's console output. logLine is reused by __log__ on the worker.
+    LogChannel logs;
+    std::string logLine;
+
+    // The chat connection and history, shared with every other instance in the
+    // process. The editor is handed pages of the history on demand and the newest
+    // part is saved with the project.
+    juce::SharedResourcePointer<ChatHub> chatHub;
+    bool subscribedToChat = false;
+    std::vector<ChatHistoryStore::Entry> pageEntries;
+    ChatSearchIndex::Result searchResult;
+
+    ChatDeliveryQueue delivery;
+
+    // Drives delivery, parameter pushes and other editor work, and decides when
+    // the shared chat poll is held. Runs from startFetchingMessages() on.
+    BackgroundScheduler scheduler;
+    bool holdingChatFetches = false;
+
+#if ELEM_HEADLESS
+    std::function<bool(std::string const&)> headlessScriptSink;
+#else
+    // The page of a closed editor, detached and idle, ready for the next one to
+    // attach instead of booting a new WebView. Message thread only.
+    std::unique_ptr<choc::ui::WebView> warmWebView;
+    bool keepWebViewWarm = ELEM_WARM_WEBVIEW;
+#endif
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EffectsPluginProcessor)
 };
@@ -0,0 +1,135 @@
+#include "PluginState.h"
+
+namespace
+{
+    // Strings are length-prefixed; anything claiming to be larger than this is
+    // treated as corruption rather than allocated.
+    constexpr juce::uint32 kMaxStringBytes = 1 << 20;
+
+    void writeString(juce::MemoryOutputStream& out, std::string const& s)
+    {
+        out.writeInt(static_cast<int>(s.size()));
+        out.write(s.data(), s.size());
+    }
+
+    bool readString(juce::MemoryInputStream& in, std::string& s)
+    {
+        auto length = static_cast<juce::uint32>(in.readInt());
+
+        if (length > kMaxStringBytes || static_cast<juce::int64>(length) > in.getNumBytesRemaining())
+            return false;
+
+        s.resize(length);
+        return in.read(s.data(), static_cast<int>(length)) == static_cast<int>(length);
+    }
+}
+
+//==============================================================================
+void PluginState::write(Contents const& contents, juce::MemoryBlock& destData)
+{
+    size_t estimatedSize = 24;
+
+    for (auto const& message : contents.history)
+        estimatedSize += 16 + message.nickname.size() + message.text.size();
+
+    for (auto const& [paramId, value] : contents.parameters)
+        estimatedSize += 8 + paramId.size();
+
+    for (auto const& message : contents.outbox)
+        estimatedSize += 12 + message.id.size() + message.nickname.size() + message.text.size();
+
+    juce::MemoryOutputStream out(destData, false);
+    out.preallocate(estimatedSize);
+
+    out.writeInt(static_cast<int>(kMagic));
+    out.writeInt(static_cast<int>(kVersion));
+    out.writeInt64(contents.cursor);
+    out.writeInt(static_cast<int>(contents.history.size()));
+
+    for (auto const& message : contents.history) {
+        out.writeInt64(message.createdAt);
+        writeString(out, message.nickname);
+        writeString(out, message.text);
+    }
+
+    out.writeInt(static_cast<int>(contents.parameters.size()));
+
+    for (auto const& [paramId, value] : contents.parameters) {
+        writeString(out, paramId);
+        out.writeFloat(value);
+    }
+
+    out.writeInt(static_cast<int>(contents.outbox.size()));
+
+    for (auto const& message : contents.outbox) {
+        writeString(out, message.id);
+        writeString(out, message.nickname);
+        writeString(out, message.text);
+    }
+}
+
+bool PluginState::read(const void* data, size_t sizeInBytes, Contents& out)
+{
+    juce::MemoryInputStream in(data, sizeInBytes, false);
+
+    if (sizeInBytes < 20 || static_cast<juce::uint32>(in.readInt()) != kMagic)
+        return false;
+
+    auto version = static_cast<juce::uint32>(in.readInt());
+
+    if (version == 0 || version > kVersion)
+        return false;
+
+    Contents contents;
+    contents.cursor = in.readInt64();
+
+    auto numMessages = static_cast<juce::uint32>(in.readInt());
+
+    // Each message takes at least 16 bytes, which bounds a corrupt count
+    if (static_cast<juce::int64>(numMessages) * 16 > in.getNumBytesRemaining())
+        return false;
+
+    contents.history.resize(numMessages);
+
+    for (auto& message : contents.history) {
+        message.createdAt = in.readInt64();
+
+        if (!readString(in, message.nickname) || !readString(in, message.text))
+            return false;
+    }
+
+    // Version 1 had no parameters; they keep their defaults
+    if (version >= 2) {
+        auto numParameters = static_cast<juce::uint32>(in.readInt());
+
+        if (static_cast<juce::int64>(numParameters) * 8 > in.getNumBytesRemaining())
+            return false;
+
+        contents.parameters.resize(numParameters);
+
+        for (auto& [paramId, value] : contents.parameters) {
+            if (!readString(in, paramId))
+                return false;
+
+            value = in.readFloat();
+        }
+    }
+
+    // Versions before 3 had no outbox
+    if (version >= 3) {
+        auto numPending = static_cast<juce::uint32>(in.readInt());
+
+        if (static_cast<juce::int64>(numPending) * 12 > in.getNumBytesRemaining())
+            return false;
+
+        contents.outbox.resize(numPending);
+
+        for (auto& message : contents.outbox) {
+            if (!readString(in, message.id) || !readString(in, message.nickname) || !readString(in, message.text))
+                return false;
+        }
+    }
+
+    out = std::move(contents);
+    return true;
+}
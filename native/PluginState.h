@@ -0,0 +1,51 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <utility>
+#include <vector>
+
+#include "ChatMessage.h"
+#include "ChatOutbox.h"
+
+
+//==============================================================================
+// The plugin's saved state: a compact, versioned binary blob rather than XML, so
+// a project reload restores it with a handful of reads and no JSON parsing.
+//
+// Layout (little endian):
+//   uint32  magic 'OSTS'
+//   uint32  version
+//   int64   chat cursor (createdAt of the newest message received)
+//   uint32  number of history messages, oldest first, each as
+//           int64 createdAt, uint32 + bytes nickname, uint32 + bytes text
+//   uint32  number of parameters (version 2+), each as
+//           uint32 + bytes id, float32 value
+//   uint32  number of unsent outbox messages (version 3+), each as
+//           uint32 + bytes id, uint32 + bytes nickname, uint32 + bytes text
+namespace PluginState
+{
+    constexpr juce::uint32 kMagic = 0x5354534f; // "OSTS"
+    constexpr juce::uint32 kVersion = 3;
+
+    // How many of the most recent messages are kept in a saved project
+    constexpr size_t kMaxHistoryMessages = 50;
+
+    struct Contents
+    {
+        int64_t cursor = 0;
+        std::vector<StoredChatMessage> history;
+
+        // Plain (not normalised) values keyed by parameter id
+        std::vector<std::pair<std::string, float>> parameters;
+
+        // Messages the server had not confirmed yet, oldest first
+        std::vector<ChatOutbox::PendingMessage> outbox;
+    };
+
+    void write(Contents const& contents, juce::MemoryBlock& destData);
+
+    // Returns false if the data is not a state blob we understand (including the
+    // empty XML written by earlier versions), leaving `out` untouched.
+    bool read(const void* data, size_t sizeInBytes, Contents& out);
+}
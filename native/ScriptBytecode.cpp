@@ -0,0 +1,67 @@
+#include "ScriptBytecode.h"
+
+namespace
+{
+    void writeLE(std::vector<uint8_t>& out, uint64_t value, int numBytes)
+    {
+        for (int i = 0; i < numBytes; ++i)
+            out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+
+    uint64_t readLE(const uint8_t* data, int numBytes)
+    {
+        uint64_t value = 0;
+
+        for (int i = 0; i < numBytes; ++i)
+            value |= static_cast<uint64_t>(data[i]) << (8 * i);
+
+        return value;
+    }
+}
+
+//==============================================================================
+uint64_t ScriptBytecode::hashSource(std::string_view source)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+
+    for (auto c : source) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 0x100000001b3ull;
+    }
+
+    return hash;
+}
+
+void ScriptBytecode::wrap(uint64_t sourceHash, const uint8_t* bytecode, size_t size, std::vector<uint8_t>& out)
+{
+    out.clear();
+    out.reserve(kHeaderSize + size);
+
+    writeLE(out, kMagic, 4);
+    writeLE(out, kVersion, 4);
+    writeLE(out, sourceHash, 8);
+    writeLE(out, size, 4);
+    out.insert(out.end(), bytecode, bytecode + size);
+}
+
+bool ScriptBytecode::unwrap(const uint8_t* data, size_t size, uint64_t expectedSourceHash,
+                            const uint8_t*& bytecode, size_t& bytecodeSize)
+{
+    if (data == nullptr || size < kHeaderSize)
+        return false;
+
+    if (readLE(data, 4) != kMagic || readLE(data + 4, 4) != kVersion)
+        return false;
+
+    if (readLE(data + 8, 8) != expectedSourceHash)
+        return false;
+
+    auto length = static_cast<size_t>(readLE(data + 16, 4));
+
+    if (length == 0 || length != size - kHeaderSize)
+        return false;
+
+    bytecode = data + kHeaderSize;
+    bytecodeSize = length;
+    return true;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+
+//==============================================================================
+// The container for precompiled QuickJS bytecode of dsp.main.js.
+//
+// The bytecode is written by the dsp-bytecode-compiler tool at build time and
+// carries a hash of the source it was compiled from, so the loader can tell
+// when the script next to it has changed (e.g. a dev rebuild of the bundle) and
+// fall back to compiling the source instead.
+//
+// Layout (little endian):
+//   uint32  magic 'OSBC'
+//   uint32  format version
+//   uint64  FNV-1a hash of the source text
+//   uint32  bytecode size, followed by the bytecode as written by JS_WriteObject
+//
+// Plain C++ so the compiler tool does not depend on JUCE.
+namespace ScriptBytecode
+{
+    constexpr uint32_t kMagic = 0x4342534f; // "OSBC"
+    constexpr uint32_t kVersion = 1;
+    constexpr size_t kHeaderSize = 20;
+
+    uint64_t hashSource(std::string_view source);
+
+    void wrap(uint64_t sourceHash, const uint8_t* bytecode, size_t size, std::vector<uint8_t>& out);
+
+    // Points `bytecode` into `data` if it is a container for the given source
+    // hash; returns false if it is malformed or stale.
+    bool unwrap(const uint8_t* data, size_t size, uint64_t expectedSourceHash,
+                const uint8_t*& bytecode, size_t& bytecodeSize);
+}
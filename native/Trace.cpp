@@ -0,0 +1,291 @@
+#include "Trace.h"
+
+#include <juce_events/juce_events.h>
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+namespace Trace::detail
+{
+    std::atomic<bool> enabled { false };
+}
+
+namespace
+{
+    struct Event
+    {
+        const char* category = nullptr;
+        const char* name = nullptr;
+        juce::int64 ticks = 0;
+        juce::int64 durationTicks = 0;
+        double value = 0.0;
+
+        // Chrome's phase letter: 'X' complete span, 'C' counter, 'i' instant
+        char phase = 'i';
+    };
+
+    // Written only by the thread that claimed it; read by the exporter up to count
+    struct ThreadBuffer
+    {
+        std::vector<Event> events;
+        std::atomic<int> count { 0 };
+        std::atomic<uint64_t> dropped { 0 };
+        char threadName[64] = {};
+    };
+
+    struct Recorder
+    {
+        // start(), stop() and export only; recording never takes it
+        juce::CriticalSection lock;
+
+        // Allocated by the first start() and never resized, so recording threads
+        // can index it without synchronisation
+        std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+        std::atomic<int> claimed { 0 };
+        std::atomic<juce::uint32> session { 0 };
+        std::atomic<uint64_t> unclaimedDropped { 0 };
+        juce::int64 sessionStartTicks = 0;
+    };
+
+    // Never destroyed, so threads still recording at shutdown are harmless
+    Recorder& getRecorder()
+    {
+        static auto* recorder = new Recorder();
+        return *recorder;
+    }
+
+    struct ThreadState
+    {
+        ThreadBuffer* buffer = nullptr;
+        juce::uint32 session = 0;
+    };
+
+    thread_local ThreadState threadState;
+
+    ThreadBuffer* getThreadBuffer() noexcept
+    {
+        auto& recorder = getRecorder();
+        auto const session = recorder.session.load(std::memory_order_acquire);
+
+        if (threadState.session != session) {
+            threadState.session = session;
+            threadState.buffer = nullptr;
+
+            auto const index = recorder.claimed.fetch_add(1);
+
+            if (index < static_cast<int>(recorder.buffers.size())) {
+                auto* buffer = recorder.buffers[static_cast<size_t>(index)].get();
+
+                // Copying a juce::String only bumps a reference count
+                if (juce::MessageManager::existsAndIsCurrentThread()) {
+                    std::snprintf(buffer->threadName, sizeof(buffer->threadName), "Message thread");
+                } else if (auto* thread = juce::Thread::getCurrentThread()) {
+                    thread->getThreadName().copyToUTF8(buffer->threadName, sizeof(buffer->threadName));
+                } else {
+                    std::snprintf(buffer->threadName, sizeof(buffer->threadName), "Host thread %d", index + 1);
+                }
+
+                threadState.buffer = buffer;
+            }
+        }
+
+        if (threadState.buffer == nullptr)
+            ++recorder.unclaimedDropped;
+
+        return threadState.buffer;
+    }
+
+    void record(Event const& event) noexcept
+    {
+        auto* buffer = getThreadBuffer();
+
+        if (buffer == nullptr)
+            return;
+
+        auto const n = buffer->count.load(std::memory_order_relaxed);
+
+        if (n >= static_cast<int>(buffer->events.size())) {
+            ++buffer->dropped;
+            return;
+        }
+
+        buffer->events[static_cast<size_t>(n)] = event;
+        buffer->count.store(n + 1, std::memory_order_release);
+    }
+
+    void appendJsonString(std::string& out, const char* text)
+    {
+        out += '"';
+
+        for (auto* c = text; c != nullptr && *c != 0; ++c) {
+            if (*c == '"' || *c == '\\')
+                out += '\\';
+
+            if (static_cast<unsigned char>(*c) >= 0x20)
+                out += *c;
+        }
+
+        out += '"';
+    }
+
+    void appendNumber(std::string& out, double value)
+    {
+        char text[32];
+        std::snprintf(text, sizeof(text), "%.3f", value);
+        out += text;
+    }
+}
+
+namespace Trace
+{
+    namespace detail
+    {
+        void complete(const char* category, const char* name, juce::int64 startTicks, juce::int64 endTicks) noexcept
+        {
+            record({ category, name, startTicks, endTicks - startTicks, 0.0, 'X' });
+        }
+
+        void counter(const char* category, const char* name, double value) noexcept
+        {
+            record({ category, name, juce::Time::getHighResolutionTicks(), 0, value, 'C' });
+        }
+
+        void instant(const char* category, const char* name) noexcept
+        {
+            record({ category, name, juce::Time::getHighResolutionTicks(), 0, 0.0, 'i' });
+        }
+    }
+
+    //==============================================================================
+    void start(int eventsPerThread, int maxThreads)
+    {
+        auto& recorder = getRecorder();
+        const juce::ScopedLock sl(recorder.lock);
+
+        detail::enabled = false;
+
+        if (recorder.buffers.empty()) {
+            for (int i = 0; i < std::max(1, maxThreads); ++i) {
+                auto buffer = std::make_unique<ThreadBuffer>();
+                buffer->events.resize(static_cast<size_t>(std::max(1024, eventsPerThread)));
+                recorder.buffers.push_back(std::move(buffer));
+            }
+        }
+
+        for (auto& buffer : recorder.buffers) {
+            buffer->count = 0;
+            buffer->dropped = 0;
+        }
+
+        recorder.claimed = 0;
+        recorder.unclaimedDropped = 0;
+        recorder.sessionStartTicks = juce::Time::getHighResolutionTicks();
+
+        // Every thread claims a fresh buffer on its next event
+        ++recorder.session;
+        detail::enabled = true;
+    }
+
+    void stop()
+    {
+        detail::enabled = false;
+    }
+
+    Stats getStats()
+    {
+        auto& recorder = getRecorder();
+        const juce::ScopedLock sl(recorder.lock);
+
+        Stats stats;
+        stats.enabled = isEnabled();
+        stats.threads = std::min(recorder.claimed.load(), static_cast<int>(recorder.buffers.size()));
+        stats.eventsDropped = recorder.unclaimedDropped.load();
+
+        for (int i = 0; i < stats.threads; ++i) {
+            auto const& buffer = *recorder.buffers[static_cast<size_t>(i)];
+            stats.eventsRecorded += static_cast<uint64_t>(buffer.count.load());
+            stats.eventsDropped += buffer.dropped.load();
+        }
+
+        return stats;
+    }
+
+    std::string toChromeJson()
+    {
+        auto& recorder = getRecorder();
+        const juce::ScopedLock sl(recorder.lock);
+
+        auto const numThreads = std::min(recorder.claimed.load(), static_cast<int>(recorder.buffers.size()));
+        auto const toMicroseconds = [&](juce::int64 ticks) {
+            return juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e6;
+        };
+
+        std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        bool first = true;
+
+        auto beginEvent = [&](const char* phase, const char* name, int tid) {
+            out += first ? "\n" : ",\n";
+            first = false;
+            out += "{\"ph\":\"";
+            out += phase;
+            out += "\",\"pid\":1,\"tid\":" + std::to_string(tid) + ",\"name\":";
+            appendJsonString(out, name);
+        };
+
+        for (int i = 0; i < numThreads; ++i) {
+            auto const& buffer = *recorder.buffers[static_cast<size_t>(i)];
+            auto const tid = i + 1;
+
+            beginEvent("M", "thread_name", tid);
+            out += ",\"args\":{\"name\":";
+            appendJsonString(out, buffer.threadName);
+            out += "}}";
+
+            auto const count = buffer.count.load(std::memory_order_acquire);
+
+            for (int e = 0; e < count; ++e) {
+                auto const& event = buffer.events[static_cast<size_t>(e)];
+                char const phase[] = { event.phase, 0 };
+
+                beginEvent(phase, event.name, tid);
+                out += ",\"cat\":";
+                appendJsonString(out, event.category);
+                out += ",\"ts\":";
+                appendNumber(out, toMicroseconds(event.ticks - recorder.sessionStartTicks));
+
+                if (event.phase == 'X') {
+                    out += ",\"dur\":";
+                    appendNumber(out, toMicroseconds(event.durationTicks));
+                } else if (event.phase == 'C') {
+                    out += ",\"args\":{\"value\":";
+                    appendNumber(out, event.value);
+                    out += "}";
+                } else {
+                    out += ",\"s\":\"t\"";
+                }
+
+                out += "}";
+            }
+        }
+
+        out += "\n]}\n";
+        return out;
+    }
+
+    bool writeChromeJson(juce::File const& file)
+    {
+        auto const json = toChromeJson();
+
+        try {
+            return file.replaceWithData(json.data(), json.size());
+        } catch (const std::exception& e) {
+            DBG("Exception writing trace: " << e.what());
+        } catch (...) {
+            DBG("Unknown exception writing trace");
+        }
+
+        return false;
+    }
+}
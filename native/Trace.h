@@ -0,0 +1,91 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <atomic>
+
+
+//==============================================================================
+// Scoped spans, counters and instants for diagnosing stalls across threads,
+// exported as Chrome trace-event JSON for chrome://tracing or Perfetto.
+//
+// Each thread that records claims its own fixed-size buffer from a pool
+// allocated by start(), and from then on appends to it without locking or
+// allocating, so this is safe on the audio thread. A full buffer drops events
+// and counts them. While tracing is off, recording costs a single relaxed load
+// and branch.
+//
+// Names and categories must be string literals (or otherwise outlive the
+// session); only their pointers are stored.
+namespace Trace
+{
+    namespace detail
+    {
+        extern std::atomic<bool> enabled;
+
+        void complete(const char* category, const char* name, juce::int64 startTicks, juce::int64 endTicks) noexcept;
+        void counter(const char* category, const char* name, double value) noexcept;
+        void instant(const char* category, const char* name) noexcept;
+    }
+
+    struct Stats
+    {
+        bool enabled = false;
+        int threads = 0;
+        uint64_t eventsRecorded = 0;
+        uint64_t eventsDropped = 0;
+    };
+
+    inline bool isEnabled() noexcept { return detail::enabled.load(std::memory_order_relaxed); }
+
+    // Message thread. Discards the previous session's events. The buffers,
+    // about 0.75 MB per thread at the defaults, are allocated by the first call
+    // and reused; threads beyond maxThreads are not recorded.
+    void start(int eventsPerThread = 1 << 14, int maxThreads = 64);
+    void stop();
+
+    // Writes everything recorded in the current or last session. Returns false
+    // if the file could not be written.
+    bool writeChromeJson(juce::File const& file);
+    std::string toChromeJson();
+
+    Stats getStats();
+
+    //==============================================================================
+    class Span
+    {
+    public:
+        Span(const char* spanCategory, const char* spanName) noexcept
+            : category(spanCategory), name(spanName),
+              startTicks(isEnabled() ? juce::Time::getHighResolutionTicks() : 0)
+        {
+        }
+
+        ~Span()
+        {
+            if (startTicks != 0)
+                detail::complete(category, name, startTicks, juce::Time::getHighResolutionTicks());
+        }
+
+    private:
+        const char* category;
+        const char* name;
+        juce::int64 startTicks;
+
+        JUCE_DECLARE_NON_COPYABLE(Span)
+    };
+
+    inline void counter(const char* category, const char* name, double value) noexcept
+    {
+        if (isEnabled())
+            detail::counter(category, name, value);
+    }
+
+    inline void instant(const char* category, const char* name) noexcept
+    {
+        if (isEnabled())
+            detail::instant(category, name);
+    }
+}
+
+#define ELEM_TRACE_SPAN(category, name) Trace::Span JUCE_JOIN_MACRO(traceSpan_, __LINE__)(category, name)
@@ -1,5 +1,7 @@
 #include "PluginProcessor.h"
 #include "WebViewEditor.h"
+#include "AssetCache.h"
+#include "Trace.h"
 
 // A helper for reading numbers from a choc::Value, which seems to opportunistically parse
 // JSON numbers into ints or 32-bit floats whenever it wants.
@@ -11,19 +13,6 @@ double numberFromChocValue(const choc::value::ValueView& v) {
         : (double)v.getInt64())));
 }
 
-std::string getMimeType(std::string const& ext) {
-    static std::unordered_map<std::string, std::string> mimeTypes{
-        { ".html",   "text/html" },
-        { ".js",     "application/javascript" },
-        { ".css",    "text/css" },
-    };
-
-    if (mimeTypes.count(ext) > 0)
-        return mimeTypes.at(ext);
-
-    return "application/octet-stream";
-}
-
 //==============================================================================
 WebViewEditor::WebViewEditor(juce::AudioProcessor* proc, juce::File const& assetDirectory, int width, int height)
     : juce::AudioProcessorEditor(proc)
@@ -31,29 +20,17 @@ WebViewEditor::WebViewEditor(juce::AudioProcessor* proc, juce::File const& asset
     setSize(width, height);
     setResizable(true, true); // Add this line to enable resizing
 
-    choc::ui::WebView::Options opts;
+    auto* processor = dynamic_cast<EffectsPluginProcessor*>(proc);
 
-#if JUCE_DEBUG
-    opts.enableDebugMode = true;
-#endif
+    // A WebView kept warm by the processor still has the page booted, so it only
+    // needs attaching and bringing up to date.
+    if (processor != nullptr)
+        webView = processor->takeWarmWebView();
 
-#if ! ELEM_DEV_LOCALHOST
-    opts.fetchResource = [=](const choc::ui::WebView::Options::Path& p) -> std::optional<choc::ui::WebView::Options::Resource> {
-        auto relPath = "." + (p == "/" ? "/index.html" : p);
-        auto f = assetDirectory.getChildFile(relPath);
-        juce::MemoryBlock mb;
-
-        if (!f.existsAsFile() || !f.loadFileAsData(mb))
-            return {};
-
-        return choc::ui::WebView::Options::Resource{
-            std::vector<uint8_t>(mb.begin(), mb.end()),
-            getMimeType(f.getFileExtension().toStdString())
-        };
-    };
-#endif
+    auto const reused = webView != nullptr;
 
-    webView = std::make_unique<choc::ui::WebView>(opts);
+    if (!reused)
+        webView = createWebView(processor, assetDirectory);
 
 #if JUCE_MAC
     viewContainer.setView(webView->getViewHandle());
@@ -65,19 +42,132 @@ WebViewEditor::WebViewEditor(juce::AudioProcessor* proc, juce::File const& asset
 
     addAndMakeVisible(viewContainer);
 
+    // Bring a reused page up to date once the host has made this the active
+    // editor, which it does only after construction.
+    if (reused) {
+        juce::MessageManager::callAsync([safeThis = juce::Component::SafePointer<WebViewEditor>(this)]() {
+            if (safeThis != nullptr) {
+                if (auto* ptr = dynamic_cast<EffectsPluginProcessor*>(safeThis->getAudioProcessor())) {
+                    ptr->handleEditorReady();
+                }
+            }
+        });
+    }
+}
+
+WebViewEditor::~WebViewEditor()
+{
+    // Detach the view before this editor's window, its parent, goes away
+#if JUCE_MAC
+    viewContainer.setView(nullptr);
+#elif JUCE_WINDOWS
+    viewContainer.setHWND(nullptr);
+#endif
+
+    if (auto* processor = dynamic_cast<EffectsPluginProcessor*>(getAudioProcessor()))
+        processor->retainWebView(std::move(webView));
+}
+
+// Creates the WebView and its bridge. The bound functions talk to the processor
+// rather than this editor, so the view can outlive the editor that created it.
+std::unique_ptr<choc::ui::WebView> WebViewEditor::createWebView(EffectsPluginProcessor* processor, juce::File const& assetDirectory)
+{
+    auto const createdAtTicks = juce::Time::getHighResolutionTicks();
+
+    choc::ui::WebView::Options opts;
+
+#if JUCE_DEBUG
+    opts.enableDebugMode = true;
+#endif
+
+#if ! ELEM_DEV_LOCALHOST
+    // Served from memory; the first editor in the process reads dist/ once
+    opts.fetchResource = [assets = AssetCache::getFor(assetDirectory)](const choc::ui::WebView::Options::Path& p) -> std::optional<choc::ui::WebView::Options::Resource> {
+        auto const* asset = assets->find(p);
+
+        if (asset == nullptr)
+            return {};
+
+        // choc takes the bytes by value, so this is the one copy per request
+        assets->noteServed(asset->data->size());
+        return choc::ui::WebView::Options::Resource{ *asset->data, asset->mimeType };
+    };
+#endif
+
+    auto webView = std::make_unique<choc::ui::WebView>(opts);
+
     // Install message passing handlers
-    webView->bind("__postNativeMessage__", [=](const choc::value::ValueView& args) -> choc::value::Value {
+    webView->bind("__postNativeMessage__", [processor, createdAtTicks](const choc::value::ValueView& args) -> choc::value::Value {
+        ELEM_TRACE_SPAN("bridge", "editor.postNativeMessage");
+
         if (args.isArray()) {
             auto eventName = args[0].getString();
 
             if (eventName == "ready") {
-                if (auto* ptr = dynamic_cast<EffectsPluginProcessor*>(getAudioProcessor())) {
-                    ptr->dispatchStateChange();
+                DBG("WebView ready after " << juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - createdAtTicks) * 1000.0 << " ms");
+
+                if (auto* ptr = processor) {
+                    ptr->handleEditorReady();
+                }
+            } else if (eventName == "messagesReceived") {
+                if (auto* ptr = processor) {
+                    ptr->acknowledgeDeliveredMessages();
+                }
+            } else if (eventName == "getMessages") {
+                // args: ["getMessages", beforeSeq, count]
+                if (args.size() > 2) {
+                    auto beforeSeq = static_cast<uint64_t>(std::max(0.0, numberFromChocValue(args[1])));
+                    auto count = static_cast<size_t>(std::clamp(numberFromChocValue(args[2]), 0.0, 500.0));
+
+                    if (auto* ptr = processor) {
+                        ptr->sendMessagePage(beforeSeq, count);
+                    }
+                }
+            } else if (eventName == "searchMessages") {
+                // args: ["searchMessages", serializedQuery]
+                if (args.size() > 1 && args[1].isString()) {
+                    if (auto* ptr = processor) {
+                        ptr->searchMessages(args[1].getString());
+                    }
+                }
+            } else if (eventName == "setParameterValue") {
+                // args: ["setParameterValue", paramId, normalizedValue]
+                if (args.size() > 2 && args[1].isString()) {
+                    if (auto* ptr = processor) {
+                        ptr->setParameterFromEditor(std::string(args[1].getString()), numberFromChocValue(args[2]));
+                    }
+                }
+            } else if (eventName == "getPerformanceStats") {
+                if (auto* ptr = processor) {
+                    ptr->sendPerformanceStats();
+                }
+            } else if (eventName == "resetPerformanceStats") {
+                if (auto* ptr = processor) {
+                    ptr->resetPerformanceStats();
+                }
+            } else if (eventName == "startTrace") {
+                if (auto* ptr = processor) {
+                    ptr->startTracing();
+                }
+            } else if (eventName == "stopTrace") {
+                if (auto* ptr = processor) {
+                    ptr->stopTracing();
+                }
+            } else if (eventName == "collectGarbage") {
+                if (auto* ptr = processor) {
+                    ptr->collectJavaScriptGarbage();
+                }
+            } else if (eventName == "captureAudio") {
+                // args: ["captureAudio", seconds, username]
+                if (args.size() > 2 && args[2].isString()) {
+                    if (auto* ptr = processor) {
+                        ptr->startAudioCapture(numberFromChocValue(args[1]), std::string(args[2].getString()));
+                    }
                 }
             } else if (eventName == "receiveMessage") {
                 if (args.size() > 1) {
                     auto messageJson = args[1].getString();
-                    if (auto* ptr = dynamic_cast<EffectsPluginProcessor*>(getAudioProcessor())) {
+                    if (auto* ptr = processor) {
                         ptr->handleChatMessage(messageJson);
                     }
                 }
@@ -85,7 +175,7 @@ WebViewEditor::WebViewEditor(juce::AudioProcessor* proc, juce::File const& asset
 
 #if ELEM_DEV_LOCALHOST
             if (eventName == "reload") {
-                if (auto* ptr = dynamic_cast<EffectsPluginProcessor*>(getAudioProcessor())) {
+                if (auto* ptr = processor) {
                     ptr->initJavaScriptEngine();
                     ptr->dispatchStateChange();
                 }
@@ -96,9 +186,22 @@ WebViewEditor::WebViewEditor(juce::AudioProcessor* proc, juce::File const& asset
         return {};
     });
 
+    // The page's send button; args: [serialized {"message", "username"}]
+    webView->bind("__sendMessage__", [processor](const choc::value::ValueView& args) -> choc::value::Value {
+        if (args.isArray() && args.size() > 0 && args[0].isString()) {
+            if (auto* ptr = processor) {
+                ptr->sendSerializedMessage(args[0].getString());
+            }
+        }
+
+        return {};
+    });
+
 #if ELEM_DEV_LOCALHOST
     webView->navigate("http://localhost:5173");
 #endif
+
+    return webView;
 }
 
 choc::ui::WebView* WebViewEditor::getWebViewPtr()
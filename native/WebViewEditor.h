@@ -5,6 +5,8 @@
 
 #include <choc_WebView.h>
 
+class EffectsPluginProcessor;
+
 
 //==============================================================================
 // A simple juce::AudioProcessorEditor that holds a choc::WebView and sets the
@@ -14,6 +16,7 @@ class WebViewEditor : public juce::AudioProcessorEditor
 public:
     //==============================================================================
     WebViewEditor(juce::AudioProcessor* proc, juce::File const& assetDirectory, int width, int height);
+    ~WebViewEditor() override;
 
     //==============================================================================
     choc::ui::WebView* getWebViewPtr();
@@ -24,6 +27,7 @@ public:
 
 private:
     //==============================================================================
+    static std::unique_ptr<choc::ui::WebView> createWebView(EffectsPluginProcessor* processor, juce::File const& assetDirectory);
 
     //==============================================================================
     std::unique_ptr<choc::ui::WebView> webView;
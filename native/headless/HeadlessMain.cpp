@@ -0,0 +1,1343 @@
+// A console harness that drives EffectsPluginProcessor without an editor or a
+// host, and prints repeatable benchmark results as JSON.
+//
+//   OSTIN_Headless [--blocks N] [--block-size N] [--sample-rate HZ]
+//                  [--messages N] [--instances N] [--startup-instances N]
+//                  [--parameters N] [--sends N] [--send-failure-interval N]
+//                  [--capture-seconds S] [--js-heap-limit-mb N]
+//                  [--search-messages N] [--page-loads N] [--server-delay-ms N]
+//                  [--delivery-probes N] [--idle-seconds S]
+//                  [--trace FILE] [--output FILE]
+//
+// dsp.main.js is read from ELEM_ASSETS_DIR, or from dist/ next to the executable.
+// Chat traffic goes to an in-process MockChatServer, never to the real API.
+#include "../PluginProcessor.h"
+#include "../AssetCache.h"
+#include "../ChatSearchIndex.h"
+#include "../DspKernels.h"
+#include "../ParameterBank.h"
+#include "../Trace.h"
+#include "MockChatServer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <new>
+#include <random>
+#include <thread>
+#include <vector>
+
+//==============================================================================
+// Every allocation in the process is counted, so a benchmark can report how many
+// it caused, and per thread, so one can check that the audio thread made none.
+// Aligned and nothrow forms fall through to these.
+namespace
+{
+    std::atomic<uint64_t> allocationCount { 0 };
+    thread_local uint64_t threadAllocationCount = 0;
+}
+
+void* operator new(std::size_t size)
+{
+    ++allocationCount;
+    ++threadAllocationCount;
+
+    if (auto* p = std::malloc(size > 0 ? size : 1))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+//==============================================================================
+namespace
+{
+    struct Options
+    {
+        int blocks = 20000;
+        int blockSize = 512;
+        double sampleRate = 48000.0;
+        int messages = 5000;
+        int instances = 8;
+        int startupInstances = 50;
+        int parameters = 128;
+        int sends = 1000;
+        int sendFailureInterval = 0;
+        double captureSeconds = 5.0;
+        int searchMessages = 100000;
+        int pageLoads = 100;
+        int serverDelayMs = 2000;
+        int deliveryProbes = 6;
+        int idleSeconds = 30;
+
+        // Negative keeps the worker's default
+        int jsHeapLimitMb = -1;
+
+        // Chrome trace-event JSON of the whole run, if set
+        juce::File trace;
+        juce::File output;
+    };
+
+    Options parseOptions(juce::ArgumentList const& args)
+    {
+        Options o;
+
+        auto intOption = [&](juce::StringRef name, int& value) {
+            if (args.containsOption(name))
+                value = std::max(1, args.getValueForOption(name).getIntValue());
+        };
+
+        intOption("--blocks", o.blocks);
+        intOption("--block-size", o.blockSize);
+        intOption("--messages", o.messages);
+        intOption("--instances", o.instances);
+        intOption("--startup-instances", o.startupInstances);
+        intOption("--parameters", o.parameters);
+        intOption("--sends", o.sends);
+        intOption("--search-messages", o.searchMessages);
+        intOption("--page-loads", o.pageLoads);
+        intOption("--server-delay-ms", o.serverDelayMs);
+        intOption("--delivery-probes", o.deliveryProbes);
+        intOption("--idle-seconds", o.idleSeconds);
+
+        if (args.containsOption("--send-failure-interval"))
+            o.sendFailureInterval = std::max(0, args.getValueForOption("--send-failure-interval").getIntValue());
+
+        if (args.containsOption("--sample-rate"))
+            o.sampleRate = std::max(1.0, args.getValueForOption("--sample-rate").getDoubleValue());
+
+        if (args.containsOption("--capture-seconds"))
+            o.captureSeconds = juce::jlimit(0.1, AudioCapture::kMaxSeconds, args.getValueForOption("--capture-seconds").getDoubleValue());
+
+        if (args.containsOption("--js-heap-limit-mb"))
+            o.jsHeapLimitMb = std::max(0, args.getValueForOption("--js-heap-limit-mb").getIntValue());
+
+        if (args.containsOption("--trace"))
+            o.trace = juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--trace"));
+
+        if (args.containsOption("--output"))
+            o.output = juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--output"));
+
+        o.parameters = std::min(o.parameters, static_cast<int>(ParameterBank::kMaxParameters));
+        return o;
+    }
+
+    double elapsedMs(juce::int64 startTicks)
+    {
+        return juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) * 1000.0;
+    }
+
+    // Runs the message loop, which delivers timers and posted callbacks, until
+    // the condition holds or the timeout passes.
+    template <typename Condition>
+    bool pumpUntil(Condition&& done, int timeoutMs)
+    {
+        auto const deadline = juce::Time::getMillisecondCounter() + static_cast<juce::uint32>(timeoutMs);
+
+        while (!done()) {
+            if (juce::Time::getMillisecondCounter() > deadline)
+                return false;
+
+            juce::MessageManager::getInstance()->runDispatchLoopUntil(1);
+        }
+
+        return true;
+    }
+
+    void pumpFor(int ms)
+    {
+        pumpUntil([] { return false; }, ms);
+    }
+
+    // Mean and percentiles of a set of samples
+    juce::var summarise(std::vector<double> samples)
+    {
+        auto* result = new juce::DynamicObject();
+
+        if (samples.empty())
+            return juce::var(result);
+
+        std::sort(samples.begin(), samples.end());
+
+        double sum = 0.0;
+
+        for (auto s : samples)
+            sum += s;
+
+        auto percentile = [&](double p) {
+            return samples[std::min(samples.size() - 1, static_cast<size_t>(p * static_cast<double>(samples.size())))];
+        };
+
+        result->setProperty("mean", sum / static_cast<double>(samples.size()));
+        result->setProperty("p50", percentile(0.5));
+        result->setProperty("p99", percentile(0.99));
+        result->setProperty("max", samples.back());
+        return juce::var(result);
+    }
+
+    std::unique_ptr<EffectsPluginProcessor> createProcessor(Options const& o, MockChatServer const& server)
+    {
+        auto processor = std::make_unique<EffectsPluginProcessor>();
+        processor->setApiBaseUrl(server.getBaseUrl().toStdString());
+
+        if (o.jsHeapLimitMb >= 0)
+            processor->setJavaScriptMemoryLimit(static_cast<size_t>(o.jsHeapLimitMb) * 1024 * 1024);
+
+        processor->initialize();
+        processor->setPlayConfigDetails(2, 2, o.sampleRate, o.blockSize);
+        processor->prepareToPlay(o.sampleRate, o.blockSize);
+        return processor;
+    }
+
+    bool waitForScript(EffectsPluginProcessor& processor)
+    {
+        return pumpUntil([&] { return processor.getJavaScriptStats().lastSetupMs > 0.0; }, 10000);
+    }
+
+    //==============================================================================
+    // A project load: every instance is created and prepared back to back, then
+    // the clock runs until the last one has its script running. The same number
+    // of scan-only instances are then created, prepared and destroyed, which
+    // should start no script and send nothing to the chat server.
+    juce::var benchmarkStartup(Options const& o, MockChatServer const& server)
+    {
+        std::vector<double> constructMs, prepareMs, scriptMs;
+        std::vector<std::unique_ptr<EffectsPluginProcessor>> processors;
+
+        auto const loadStart = juce::Time::getHighResolutionTicks();
+
+        for (int i = 0; i < o.startupInstances; ++i) {
+            auto const start = juce::Time::getHighResolutionTicks();
+            auto processor = std::make_unique<EffectsPluginProcessor>();
+            processor->setApiBaseUrl(server.getBaseUrl().toStdString());
+            processor->initialize();
+            constructMs.push_back(elapsedMs(start));
+
+            auto const prepareStart = juce::Time::getHighResolutionTicks();
+            processor->setPlayConfigDetails(2, 2, o.sampleRate, o.blockSize);
+            processor->prepareToPlay(o.sampleRate, o.blockSize);
+            prepareMs.push_back(elapsedMs(prepareStart));
+
+            processors.push_back(std::move(processor));
+        }
+
+        auto const allReady = pumpUntil([&] {
+            return std::all_of(processors.begin(), processors.end(), [](auto const& p) {
+                return p->getJavaScriptStats().lastSetupMs > 0.0;
+            });
+        }, 60000);
+
+        auto const readyMs = elapsedMs(loadStart);
+
+        for (auto const& processor : processors)
+            scriptMs.push_back(processor->getJavaScriptStats().lastSetupMs);
+
+        processors.clear();
+        pumpFor(100);
+
+        std::vector<double> scanMs;
+        auto const requestsBefore = server.getRequestsServed();
+        uint64_t scanScripts = 0;
+
+        for (int i = 0; i < o.startupInstances; ++i) {
+            auto const start = juce::Time::getHighResolutionTicks();
+            auto processor = std::make_unique<EffectsPluginProcessor>();
+            processor->setApiBaseUrl(server.getBaseUrl().toStdString());
+            processor->initialize();
+            processor->setScanOnly(true);
+            processor->setPlayConfigDetails(2, 2, o.sampleRate, o.blockSize);
+            processor->prepareToPlay(o.sampleRate, o.blockSize);
+            scanScripts += processor->getJavaScriptStats().contextsCreated;
+            processor.reset();
+            scanMs.push_back(elapsedMs(start));
+        }
+
+        // Anything a scan instance had queued would show up on the server by now
+        pumpFor(500);
+
+        auto* scan = new juce::DynamicObject();
+        scan->setProperty("instanceMs", summarise(std::move(scanMs)));
+        scan->setProperty("scriptsStarted", static_cast<juce::int64>(scanScripts));
+        scan->setProperty("chatRequests", static_cast<juce::int64>(server.getRequestsServed() - requestsBefore));
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("instances", o.startupInstances);
+        result->setProperty("allReady", allReady);
+        result->setProperty("instantiateToReadyMs", readyMs);
+        result->setProperty("constructMs", summarise(std::move(constructMs)));
+        result->setProperty("prepareMs", summarise(std::move(prepareMs)));
+        result->setProperty("scriptLoadMs", summarise(std::move(scriptMs)));
+        result->setProperty("scanOnly", juce::var(scan));
+        return juce::var(result);
+    }
+
+    //==============================================================================
+    // What an editor pays for its assets: building the in-memory cache of dist/,
+    // then page loads that request every file in it, served from the cache as
+    // the WebView's fetchResource does and, for comparison, read from disk.
+    juce::var benchmarkAssets(Options const& o)
+    {
+        auto const directory = EffectsPluginProcessor::getAssetsDirectory();
+        auto* result = new juce::DynamicObject();
+        result->setProperty("found", directory.isDirectory());
+
+        if (!directory.isDirectory())
+            return juce::var(result);
+
+        std::vector<std::string> paths { "/" };
+        std::vector<juce::File> files;
+
+        for (auto const& entry : juce::RangedDirectoryIterator(directory, true, "*", juce::File::findFiles)) {
+            auto const relative = entry.getFile().getRelativePathFrom(directory).replaceCharacter('\\', '/');
+
+            if (relative != "index.html")
+                paths.push_back("/" + relative.toStdString());
+
+            files.push_back(entry.getFile());
+        }
+
+        // The first build reads dist/ cold, as the first editor in the process does
+        std::vector<double> buildMs;
+        std::unique_ptr<AssetCache> cache;
+
+        for (int i = 0; i < 5; ++i) {
+            cache = std::make_unique<AssetCache>(directory);
+            buildMs.push_back(cache->getStats().buildMs);
+        }
+
+        std::vector<double> lookupNs, pageLoadMs, diskPageLoadMs;
+        lookupNs.reserve(paths.size() * static_cast<size_t>(o.pageLoads));
+        size_t missing = 0;
+
+        for (int i = 0; i < o.pageLoads; ++i) {
+            auto const start = juce::Time::getHighResolutionTicks();
+
+            for (auto const& path : paths) {
+                auto const lookupStart = juce::Time::getHighResolutionTicks();
+                auto const* asset = cache->find(path);
+                lookupNs.push_back(elapsedMs(lookupStart) * 1.0e6);
+
+                if (asset == nullptr) {
+                    ++missing;
+                    continue;
+                }
+
+                // choc takes the bytes by value
+                std::vector<uint8_t> copy(*asset->data);
+                cache->noteServed(copy.size());
+            }
+
+            pageLoadMs.push_back(elapsedMs(start));
+        }
+
+        for (int i = 0; i < o.pageLoads; ++i) {
+            auto const start = juce::Time::getHighResolutionTicks();
+
+            for (auto const& file : files) {
+                juce::MemoryBlock mb;
+                file.loadFileAsData(mb);
+            }
+
+            diskPageLoadMs.push_back(elapsedMs(start));
+        }
+
+        auto const stats = cache->getStats();
+
+        result->setProperty("assets", static_cast<juce::int64>(stats.numAssets));
+        result->setProperty("totalBytes", static_cast<juce::int64>(stats.totalBytes));
+        result->setProperty("coldBuildMs", buildMs.front());
+        result->setProperty("buildMs", summarise(std::move(buildMs)));
+        result->setProperty("pageLoads", o.pageLoads);
+        result->setProperty("requestsPerPageLoad", static_cast<juce::int64>(stats.requestsServed / static_cast<uint64_t>(o.pageLoads)));
+        result->setProperty("bytesServedPerPageLoad", static_cast<juce::int64>(stats.bytesServed / static_cast<uint64_t>(o.pageLoads)));
+        result->setProperty("missing", static_cast<juce::int64>(missing));
+        result->setProperty("lookupNs", summarise(std::move(lookupNs)));
+        result->setProperty("pageLoadMs", summarise(std::move(pageLoadMs)));
+        result->setProperty("diskPageLoadMs", summarise(std::move(diskPageLoadMs)));
+        return juce::var(result);
+    }
+
+    //==============================================================================
+    // The script engine's footprint per instance, once the script has settled
+    // and again after a full collection, and what that collection cost.
+    juce::var benchmarkJavaScriptMemory(Options const& o, MockChatServer const& server)
+    {
+        std::vector<std::unique_ptr<EffectsPluginProcessor>> processors;
+
+        for (int i = 0; i < o.instances; ++i) {
+            processors.push_back(createProcessor(o, server));
+            waitForScript(*processors.back());
+        }
+
+        // Long enough for the idle collection to have run once
+        pumpFor(1500);
+
+        std::vector<double> settledBytes, collectedBytes, objects, gcMs;
+        size_t totalBytes = 0;
+
+        for (auto& processor : processors) {
+            settledBytes.push_back(static_cast<double>(processor->getJavaScriptStats().heapBytes));
+
+            auto const runsBefore = processor->getJavaScriptStats().gcRuns;
+            processor->collectJavaScriptGarbage();
+            pumpUntil([&] { return processor->getJavaScriptStats().gcRuns > runsBefore; }, 5000);
+
+            auto const stats = processor->getJavaScriptStats();
+            collectedBytes.push_back(static_cast<double>(stats.heapBytesAfterGc));
+            objects.push_back(static_cast<double>(stats.objectCount));
+            gcMs.push_back(stats.lastGcMs);
+            totalBytes += stats.heapBytesAfterGc;
+        }
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("instances", o.instances);
+        result->setProperty("memoryLimitBytes", static_cast<juce::int64>(processors.empty() ? 0 : processors.front()->getJavaScriptStats().memoryLimitBytes));
+        result->setProperty("settledHeapBytes", summarise(std::move(settledBytes)));
+        result->setProperty("collectedHeapBytes", summarise(std::move(collectedBytes)));
+        result->setProperty("objectCount", summarise(std::move(objects)));
+        result->setProperty("gcMs", summarise(std::move(gcMs)));
+        result->setProperty("totalHeapBytes", static_cast<juce::int64>(totalBytes));
+        return juce::var(result);
+    }
+
+    //==============================================================================
+    // Per-block cost of processBlock with settled parameters, and with both
+    // parameters automated on every block.
+    juce::var benchmarkProcessBlock(Options const& o, MockChatServer const& server)
+    {
+        auto processor = createProcessor(o, server);
+        auto const scriptLoaded = waitForScript(*processor);
+
+        juce::MidiBuffer midi;
+        juce::Random random(1);
+
+        auto const& params = processor->getParameters();
+
+        // The same stretch of audio at each size, so the rows compare per sample
+        auto const totalSamples = static_cast<juce::int64>(o.blocks) * o.blockSize;
+
+        juce::Array<juce::var> rows;
+
+        for (int blockSize : { 32, 64, 128, 256, 512, 1024, 2048 }) {
+            // A new block size rebuilds the runtime, which reloads the script
+            auto const contextsBefore = processor->getJavaScriptStats().contextsCreated;
+            processor->releaseResources();
+            processor->setPlayConfigDetails(2, 2, o.sampleRate, blockSize);
+            processor->prepareToPlay(o.sampleRate, blockSize);
+
+            auto const reloaded = pumpUntil([&] { return processor->getJavaScriptStats().contextsCreated > contextsBefore; }, 10000);
+
+            // Let the first render land in the runtime
+            pumpFor(200);
+
+            auto const blocks = static_cast<int>(std::max<juce::int64>(1, totalSamples / blockSize));
+            juce::AudioBuffer<float> buffer(2, blockSize);
+
+            auto fillInput = [&] {
+                for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                    for (int i = 0; i < buffer.getNumSamples(); ++i)
+                        buffer.setSample(ch, i, random.nextFloat() * 2.0f - 1.0f);
+            };
+
+            // Results go into preallocated vectors so the runs themselves allocate
+            // only what processBlock does
+            auto run = [&](bool automate, std::vector<double>& blockNs) {
+                blockNs.clear();
+
+                for (int b = 0; b < blocks; ++b) {
+                    fillInput();
+
+                    if (automate)
+                        for (auto* param : params)
+                            param->setValueNotifyingHost(random.nextFloat());
+
+                    auto const start = juce::Time::getHighResolutionTicks();
+                    processor->processBlock(buffer, midi);
+                    blockNs.push_back(elapsedMs(start) * 1.0e6);
+                }
+            };
+
+            std::vector<double> settled, automated;
+            settled.reserve(static_cast<size_t>(blocks));
+            automated.reserve(static_cast<size_t>(blocks));
+
+            run(false, settled); // warm-up
+
+            // Only this thread's count: the script and network threads keep
+            // allocating meanwhile, and none of that is processBlock's doing
+            auto const allocationsBefore = threadAllocationCount;
+            run(false, settled);
+            auto const settledAllocations = threadAllocationCount - allocationsBefore;
+            run(true, automated);
+
+            auto* row = new juce::DynamicObject();
+            row->setProperty("blockSize", blockSize);
+            row->setProperty("blocks", blocks);
+            row->setProperty("scriptReloaded", reloaded);
+            row->setProperty("realtimeBudgetNs", 1.0e9 * blockSize / o.sampleRate);
+            row->setProperty("settledNs", summarise(std::move(settled)));
+            row->setProperty("automatedNs", summarise(std::move(automated)));
+            row->setProperty("settledAllocations", static_cast<juce::int64>(settledAllocations));
+
+            // The processor's own measurement over all three runs; preparing
+            // for the next size clears it
+            row->setProperty("blockTiming", BlockTimer::toVar(processor->getBlockTimingStats()));
+            rows.add(juce::var(row));
+        }
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("scriptLoaded", scriptLoaded);
+        result->setProperty("blockSizes", rows);
+        return juce::var(result);
+    }
+
+    //==============================================================================
+    // The smoothing layer alone, with every parameter moving on every block and
+    // with none moving.
+    juce::var benchmarkParameterBank(Options const& o)
+    {
+        std::vector<ParameterBank::Spec> specs;
+
+        for (int i = 0; i < o.parameters; ++i)
+            specs.push_back({ "p" + std::to_string(i), "P" + std::to_string(i), 0.0f, 1.0f, 0.5f });
+
+        ParameterBank bank(std::move(specs));
+        bank.prepare(o.sampleRate, o.blockSize);
+
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<float> value(0.0f, 1.0f);
+
+        auto run = [&](bool automate) {
+            std::vector<double> blockNs;
+            blockNs.reserve(static_cast<size_t>(o.blocks));
+
+            for (int b = 0; b < o.blocks; ++b) {
+                auto const start = juce::Time::getHighResolutionTicks();
+
+                if (automate)
+                    for (size_t i = 0; i < bank.size(); ++i)
+                        bank.setTarget(i, value(rng));
+
+                bank.process(o.blockSize);
+                blockNs.push_back(elapsedMs(start) * 1.0e6);
+            }
+
+            return blockNs;
+        };
+
+        auto automated = run(true);
+        run(false); // let every ramp settle
+        auto settled = run(false);
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("parameters", static_cast<int>(bank.size()));
+        result->setProperty("allAutomatedNs", summarise(std::move(automated)));
+        result->setProperty("settledNs", summarise(std::move(settled)));
+        return juce::var(result);
+    }
+
+    //==============================================================================
+    // Builds a history and its search index from a synthetic chat with a skewed
+    // vocabulary, then times the kinds of query the editor sends.
+    juce::var benchmarkSearch(Options const& o)
+    {
+        constexpr int kVocabulary = 20000;
+        constexpr int kNicknames = 200;
+        constexpr int kRuns = 200;
+
+        auto const numMessages = static_cast<size_t>(o.searchMessages);
+
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        std::uniform_int_distribution<int> length(3, 20);
+
+        // Made-up words of one to four syllables, so prefixes spread over the
+        // vocabulary about as they do in a real language
+        static const char* const syllables[] = { "ka", "to", "ri", "mu", "se", "la", "po", "ne",
+                                                 "di", "ga", "vo", "chi", "re", "bu", "fa", "lo" };
+
+        std::uniform_int_distribution<int> numSyllables(1, 4);
+        std::uniform_int_distribution<size_t> syllable(0, std::size(syllables) - 1);
+        std::vector<std::string> vocabulary(kVocabulary);
+
+        for (auto& w : vocabulary)
+            for (int n = numSyllables(rng); n > 0; --n)
+                w += syllables[syllable(rng)];
+
+        // A few very common words and a long tail, roughly as in real chat
+        auto word = [&]() -> std::string const& {
+            return vocabulary[static_cast<size_t>(std::pow(static_cast<double>(kVocabulary), uniform(rng))) - 1];
+        };
+
+        ChatHistoryStore history(numMessages);
+        ChatSearchIndex index;
+
+        std::string text;
+        std::string nickname;
+        double buildMs = 0.0;
+
+        for (size_t i = 0; i < numMessages; ++i) {
+            text.clear();
+
+            for (int w = length(rng); w > 0; --w) {
+                text += word();
+                text += ' ';
+            }
+
+            nickname = "user" + std::to_string(static_cast<int>(std::pow(static_cast<double>(kNicknames), uniform(rng))));
+
+            ChatMessage message;
+            message.nickname = nickname;
+            message.text = text;
+            message.createdAt = static_cast<int64_t>(i + 1) * 1000;
+
+            auto const start = juce::Time::getHighResolutionTicks();
+            index.add(history.append(message), message);
+            buildMs += elapsedMs(start);
+        }
+
+        auto const span = static_cast<int64_t>(numMessages) * 1000;
+
+        struct Case
+        {
+            const char* name;
+            ChatSearchIndex::Query query;
+        };
+
+        std::vector<Case> cases;
+        cases.push_back({ "commonTerm", { vocabulary[0] } });
+        cases.push_back({ "rareTerm", { vocabulary[kVocabulary / 2] } });
+        cases.push_back({ "shortPrefix", { vocabulary[1].substr(0, 2) } });
+        cases.push_back({ "conjunction", { vocabulary[2] + " " + vocabulary[5] + " " + vocabulary[30] } });
+        cases.push_back({ "nickname", { vocabulary[10], "user7" } });
+        cases.push_back({ "timeRange", { vocabulary[0], "", span / 2, span / 2 + span / 100 } });
+
+        ChatSearchIndex::Result result;
+        auto* queries = new juce::DynamicObject();
+
+        for (auto const& c : cases) {
+            std::vector<double> queryUs;
+            queryUs.reserve(kRuns);
+
+            for (int r = 0; r < kRuns; ++r) {
+                auto const start = juce::Time::getHighResolutionTicks();
+                index.search(c.query, result);
+                queryUs.push_back(elapsedMs(start) * 1000.0);
+            }
+
+            auto* entry = new juce::DynamicObject();
+            entry->setProperty("matches", static_cast<juce::int64>(result.totalMatches));
+            entry->setProperty("exact", result.totalIsExact);
+            entry->setProperty("latencyUs", summarise(std::move(queryUs)));
+            queries->setProperty(c.name, juce::var(entry));
+        }
+
+        auto* out = new juce::DynamicObject();
+        out->setProperty("messages", static_cast<juce::int64>(index.size()));
+        out->setProperty("terms", static_cast<juce::int64>(index.getNumTerms()));
+        out->setProperty("postings", static_cast<juce::int64>(index.getNumPostings()));
+        out->setProperty("buildMs", buildMs);
+        out->setProperty("queries", juce::var(queries));
+        return juce::var(out);
+    }
+
+    //==============================================================================
+    // Poll ticks on the message thread while the server sits on every request:
+    // what a tick costs, and how long other message-thread work waits meanwhile.
+    // Only the first tick should reach the server; the rest find it in flight.
+    juce::var benchmarkSlowServer(Options const& o, MockChatServer& server)
+    {
+        constexpr int kTicks = 100;
+
+        auto processor = std::make_unique<EffectsPluginProcessor>();
+        processor->setApiBaseUrl(server.getBaseUrl().toStdString());
+
+        auto& hub = processor->getChatHub();
+        auto const statsBefore = hub.getStats();
+        auto const requestsBefore = server.getRequestsServed();
+
+        server.setResponseDelayMs(o.serverDelayMs);
+
+        std::vector<double> tickUs, loopLatencyMs;
+        auto const start = juce::Time::getHighResolutionTicks();
+
+        for (int i = 0; i < kTicks; ++i) {
+            auto const tickStart = juce::Time::getHighResolutionTicks();
+            hub.fetchNewMessages();
+            tickUs.push_back(elapsedMs(tickStart) * 1000.0);
+
+            // A callback posted now runs once the message thread is free again
+            auto ran = std::make_shared<bool>(false);
+            auto const postedAt = juce::Time::getHighResolutionTicks();
+
+            juce::MessageManager::callAsync([ran, postedAt, &loopLatencyMs] {
+                loopLatencyMs.push_back(elapsedMs(postedAt));
+                *ran = true;
+            });
+
+            pumpUntil([&] { return *ran; }, 1000);
+            pumpFor(5);
+        }
+
+        auto const ticksMs = elapsedMs(start);
+        auto const fetchesWhileStalled = hub.getStats().fetches - statsBefore.fetches;
+
+        // Let the stalled poll, and the one queued behind it, finish before the
+        // next benchmark uses the server
+        server.setResponseDelayMs(0);
+        auto const answered = pumpUntil([&] { return hub.getStats().responses >= statsBefore.responses + 2; }, o.serverDelayMs + 5000);
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("serverDelayMs", o.serverDelayMs);
+        result->setProperty("ticks", kTicks);
+        result->setProperty("ticksMs", ticksMs);
+        result->setProperty("tickUs", summarise(std::move(tickUs)));
+        result->setProperty("messageLoopLatencyMs", summarise(std::move(loopLatencyMs)));
+        result->setProperty("fetchesWhileStalled", static_cast<juce::int64>(fetchesWhileStalled));
+        result->setProperty("answered", answered);
+        result->setProperty("requests", static_cast<juce::int64>(server.getRequestsServed() - requestsBefore));
+        return juce::var(result);
+    }
+
+    //==============================================================================
+    // Records when each message text first reaches the hub's listeners
+    struct DeliveryProbe : public ChatHub::Listener
+    {
+        std::map<juce::String, juce::int64> receivedAt;
+
+        void chatMessagesReceived(std::shared_ptr<const ChatHub::Batch> const& batch) override
+        {
+            auto const now = juce::Time::getHighResolutionTicks();
+
+            for (auto const& entry : *batch)
+                receivedAt.emplace(juce::JSON::parse(juce::String(entry.json))["text"].toString(), now);
+        }
+    };
+
+    // Messages posted by another user, timed from the server to a hub
+    // listener, then the requests the transport makes while chat is idle.
+    juce::var benchmarkTransport(Options const& o, bool streaming)
+    {
+        // Spaced so that the probes land at different points of the poll interval
+        constexpr int kProbeSpacingMs = 3700;
+
+        // Its own server, which serves the messages posted to it
+        MockChatServer server(0);
+
+        if (!server.start())
+            return {};
+
+        auto processor = std::make_unique<EffectsPluginProcessor>();
+        processor->setApiBaseUrl(server.getBaseUrl().toStdString());
+        processor->setStreamingEnabled(streaming);
+
+        auto& hub = processor->getChatHub();
+        DeliveryProbe probe;
+        hub.addListener(&probe);
+
+        auto const connected = !streaming || pumpUntil([&] { return server.getNumOpenStreams() > 0; }, 10000);
+
+        std::vector<juce::int64> postedAt;
+
+        for (int i = 0; i < o.deliveryProbes; ++i) {
+            if (i > 0)
+                pumpFor(kProbeSpacingMs);
+
+            postedAt.push_back(juce::Time::getHighResolutionTicks());
+            server.postMessage("bench-probe", "delivery probe " + std::to_string(i));
+        }
+
+        auto const delivered = pumpUntil([&] { return probe.receivedAt.size() >= postedAt.size(); }, 15000);
+        std::vector<double> latencyMs;
+
+        for (size_t i = 0; i < postedAt.size(); ++i) {
+            auto const it = probe.receivedAt.find("delivery probe " + juce::String(static_cast<int>(i)));
+
+            if (it != probe.receivedAt.end())
+                latencyMs.push_back(juce::Time::highResolutionTicksToSeconds(it->second - postedAt[i]) * 1000.0);
+        }
+
+        auto const requestsBefore = server.getRequestsServed();
+        pumpFor(o.idleSeconds * 1000);
+        auto const idleRequests = server.getRequestsServed() - requestsBefore;
+
+        hub.removeListener(&probe);
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("connected", connected);
+        result->setProperty("delivered", delivered);
+        result->setProperty("probes", static_cast<int>(postedAt.size()));
+        result->setProperty("latencyMs", summarise(std::move(latencyMs)));
+        result->setProperty("idleRequests", static_cast<juce::int64>(idleRequests));
+        result->setProperty("idleRequestsPerMinute", static_cast<double>(idleRequests) * 60.0 / o.idleSeconds);
+        return juce::var(result);
+    }
+
+    juce::var benchmarkDelivery(Options const& o)
+    {
+        auto* result = new juce::DynamicObject();
+        result->setProperty("polling", benchmarkTransport(o, false));
+        result->setProperty("streaming", benchmarkTransport(o, true));
+        return juce::var(result);
+    }
+
+    //==============================================================================
+    // Poll, decode, store, serialise and deliver messages from the mock server
+    // as fast as the processor will take them. The other instances share the
+    // chat hub without an editor, so requests should not grow with their number.
+    juce::var benchmarkMessagePipeline(Options const& o, MockChatServer& server)
+    {
+        std::vector<std::unique_ptr<EffectsPluginProcessor>> others;
+
+        for (int i = 1; i < o.instances; ++i) {
+            others.push_back(std::make_unique<EffectsPluginProcessor>());
+            others.back()->startFetchingMessages();
+        }
+
+        auto processor = std::make_unique<EffectsPluginProcessor>();
+        processor->setApiBaseUrl(server.getBaseUrl().toStdString());
+        processor->startFetchingMessages();
+
+        uint64_t scriptsDelivered = 0, bytesDelivered = 0;
+        auto* raw = processor.get();
+
+        // Plays the editor's part: take each batch and acknowledge it a moment later
+        processor->setHeadlessScriptSink([&scriptsDelivered, &bytesDelivered, raw](std::string const& script) {
+            ++scriptsDelivered;
+            bytesDelivered += script.size();
+            juce::MessageManager::callAsync([raw] { raw->acknowledgeDeliveredMessages(); });
+            return true;
+        });
+
+        auto& stats = ChatPipelineStats::get();
+        stats.reset();
+
+        auto const requestsBefore = server.getRequestsServed();
+        auto const allocationsBefore = allocationCount.load();
+        auto const start = juce::Time::getHighResolutionTicks();
+        bool completed = true;
+
+        while (stats.messagesDecoded.load() < static_cast<uint64_t>(o.messages)) {
+            auto const decodedBefore = stats.messagesDecoded.load();
+            processor->fetchNewMessages();
+
+            if (!pumpUntil([&] { return stats.messagesDecoded.load() > decodedBefore; }, 5000)) {
+                completed = false;
+                break;
+            }
+        }
+
+        auto const ms = elapsedMs(start);
+        auto const allocations = allocationCount.load() - allocationsBefore;
+        auto const snapshot = stats.snapshot();
+
+        // Drain the last batch and its acknowledgement before the processor goes
+        pumpFor(100);
+        processor->setHeadlessScriptSink(nullptr);
+        pumpFor(20);
+
+        auto const messages = std::max<uint64_t>(1, snapshot.messagesDecoded);
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("completed", completed);
+        result->setProperty("instances", o.instances);
+        result->setProperty("messages", static_cast<juce::int64>(snapshot.messagesDecoded));
+        result->setProperty("requests", static_cast<juce::int64>(server.getRequestsServed() - requestsBefore));
+        result->setProperty("elapsedMs", ms);
+        result->setProperty("messagesPerSecond", static_cast<double>(snapshot.messagesDecoded) * 1000.0 / std::max(ms, 1.0e-3));
+        result->setProperty("allocationsPerMessage", static_cast<double>(allocations) / static_cast<double>(messages));
+        result->setProperty("decodeNsPerMessage", static_cast<double>(snapshot.decodeNanos) / static_cast<double>(messages));
+        result->setProperty("serializeNsPerMessage", static_cast<double>(snapshot.serializeNanos) / static_cast<double>(messages));
+        result->setProperty("deliveryScripts", static_cast<juce::int64>(scriptsDelivered));
+        result->setProperty("deliveryBytes", static_cast<juce::int64>(bytesDelivered));
+        return juce::var(result);
+    }
+
+    //==============================================================================
+    // A capture stress test: processBlock at 32-sample blocks on its own thread,
+    // paced to real time, while a snippet is recorded, encoded to FLAC and posted
+    // to the mock server. Passes with no dropped samples and no allocations on
+    // the audio thread.
+    juce::var benchmarkCapture(Options const& o, MockChatServer& server)
+    {
+        constexpr int kBlockSize = 32;
+
+        auto captureOptions = o;
+        captureOptions.blockSize = kBlockSize;
+
+        auto processor = createProcessor(captureOptions, server);
+        auto const scriptLoaded = waitForScript(*processor);
+        pumpFor(200);
+
+        juce::AudioBuffer<float> buffer(2, kBlockSize);
+        juce::MidiBuffer midi;
+        juce::Random random(5);
+
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            for (int i = 0; i < kBlockSize; ++i)
+                buffer.setSample(ch, i, random.nextFloat() * 2.0f - 1.0f);
+
+        processor->resetPerformanceStats();
+
+        auto const sendsBefore = server.getSendsAccepted();
+        auto const started = processor->startAudioCapture(o.captureSeconds, "bench-capture");
+
+        // Half a second either side of the capture
+        auto const totalBlocks = static_cast<int>((o.captureSeconds + 1.0) * o.sampleRate / kBlockSize);
+        auto const blocksPerChunk = std::max(1, static_cast<int>(0.01 * o.sampleRate / kBlockSize));
+        std::atomic<bool> audioDone { false };
+        uint64_t audioThreadAllocations = 0;
+
+        std::thread audioThread([&] {
+            juce::ScopedNoDenormals noDenormals;
+            auto const start = std::chrono::steady_clock::now();
+            auto const allocationsBefore = threadAllocationCount;
+
+            for (int b = 0; b < totalBlocks; ++b) {
+                processor->processBlock(buffer, midi);
+
+                if ((b + 1) % blocksPerChunk == 0) {
+                    auto const due = std::chrono::duration<double>((b + 1) * kBlockSize / o.sampleRate);
+                    std::this_thread::sleep_until(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(due));
+                }
+            }
+
+            audioThreadAllocations = threadAllocationCount - allocationsBefore;
+            audioDone = true;
+        });
+
+        auto const uploaded = pumpUntil([&] {
+            return audioDone.load() && server.getSendsAccepted() > sendsBefore;
+        }, static_cast<int>(o.captureSeconds * 1000.0) + 20000);
+
+        audioThread.join();
+
+        auto const capture = processor->getCaptureStats();
+        auto const timing = processor->getBlockTimingStats();
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("scriptLoaded", scriptLoaded);
+        result->setProperty("started", started);
+        result->setProperty("uploaded", uploaded);
+        result->setProperty("blockSize", kBlockSize);
+        result->setProperty("seconds", o.captureSeconds);
+        result->setProperty("samplesCaptured", static_cast<juce::int64>(capture.samplesCaptured));
+        result->setProperty("samplesDropped", static_cast<juce::int64>(capture.samplesDropped));
+        result->setProperty("audioThreadAllocations", static_cast<juce::int64>(audioThreadAllocations));
+        result->setProperty("encodeMs", capture.lastEncodeMs);
+        result->setProperty("flacBytes", static_cast<juce::int64>(capture.lastEncodedBytes));
+        result->setProperty("blockTiming", BlockTimer::toVar(timing));
+        result->setProperty("passed", started && uploaded && capture.samplesDropped == 0 && audioThreadAllocations == 0);
+        return juce::var(result);
+    }
+
+    //==============================================================================
+    // An offline bounce: processBlock as fast as it will go on a render thread,
+    // with gain automated, first with the chat quiet and then with a busy chat
+    // and an editor open, once unthrottled and once with the scheduler holding
+    // background work back. Each run reports its render throughput and the
+    // background work done during and just after the render.
+    juce::var benchmarkOfflineRender(Options const& o, MockChatServer& server)
+    {
+        // A busy room: a fetch this often, each bringing a page of messages
+        constexpr juce::uint32 kChatFetchIntervalMs = 5;
+
+        struct Run
+        {
+            const char* name;
+            bool chat;
+            bool throttle;
+        };
+
+        auto* result = new juce::DynamicObject();
+        double throttledBlocksPerSecond = 0.0, unthrottledBlocksPerSecond = 0.0;
+
+        for (auto const& run : { Run { "chatOff", false, true }, Run { "chatOnUnthrottled", true, false }, Run { "chatOnThrottled", true, true } }) {
+            auto processor = createProcessor(o, server);
+            auto const scriptLoaded = waitForScript(*processor);
+            pumpFor(200);
+
+            uint64_t scripts = 0;
+            auto* raw = processor.get();
+
+            processor->setHeadlessScriptSink([&scripts, raw](std::string const&) {
+                ++scripts;
+                juce::MessageManager::callAsync([raw] { raw->acknowledgeDeliveredMessages(); });
+                return true;
+            });
+
+            auto& hub = processor->getChatHub();
+            auto const fetchesBefore = hub.getStats().fetches;
+            auto const deferredBefore = hub.getStats().fetchesDeferred;
+
+            processor->getScheduler().setThrottlingEnabled(run.throttle);
+            processor->setNonRealtime(true);
+
+            std::atomic<bool> renderDone { false };
+            double renderMs = 0.0;
+
+            std::thread renderThread([&] {
+                juce::AudioBuffer<float> buffer(2, o.blockSize);
+                juce::MidiBuffer midi;
+                juce::Random random(7);
+                auto* gain = processor->getParameters()[0];
+                auto const start = juce::Time::getHighResolutionTicks();
+
+                for (int b = 0; b < o.blocks; ++b) {
+                    for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                        for (int i = 0; i < buffer.getNumSamples(); ++i)
+                            buffer.setSample(ch, i, random.nextFloat() * 2.0f - 1.0f);
+
+                    gain->setValueNotifyingHost(static_cast<float>(b % 100) / 100.0f);
+                    processor->processBlock(buffer, midi);
+                }
+
+                renderMs = elapsedMs(start);
+                renderDone = true;
+            });
+
+            auto lastFetchMs = juce::Time::getMillisecondCounter();
+
+            pumpUntil([&] {
+                if (run.chat && juce::Time::getMillisecondCounter() - lastFetchMs >= kChatFetchIntervalMs) {
+                    processor->fetchNewMessages();
+                    lastFetchMs = juce::Time::getMillisecondCounter();
+                }
+
+                return renderDone.load();
+            }, 600000);
+
+            renderThread.join();
+
+            auto const scriptsDuringRender = scripts;
+            auto const fetchesDuringRender = hub.getStats().fetches - fetchesBefore;
+
+            // Whatever was held back runs now, once
+            processor->setNonRealtime(false);
+            pumpFor(500);
+
+            auto const blocksPerSecond = o.blocks * 1000.0 / std::max(renderMs, 1.0e-3);
+
+            if (run.chat)
+                (run.throttle ? throttledBlocksPerSecond : unthrottledBlocksPerSecond) = blocksPerSecond;
+
+            auto* entry = new juce::DynamicObject();
+            entry->setProperty("scriptLoaded", scriptLoaded);
+            entry->setProperty("renderMs", renderMs);
+            entry->setProperty("blocksPerSecond", blocksPerSecond);
+            entry->setProperty("realtimeFactor", blocksPerSecond * o.blockSize / o.sampleRate);
+            entry->setProperty("fetchesDuringRender", static_cast<juce::int64>(fetchesDuringRender));
+            entry->setProperty("fetchesDeferred", static_cast<juce::int64>(hub.getStats().fetchesDeferred - deferredBefore));
+            entry->setProperty("fetchesAfterRender", static_cast<juce::int64>(hub.getStats().fetches - fetchesBefore - fetchesDuringRender));
+            entry->setProperty("editorScriptsDuringRender", static_cast<juce::int64>(scriptsDuringRender));
+            entry->setProperty("editorScriptsAfterRender", static_cast<juce::int64>(scripts - scriptsDuringRender));
+            entry->setProperty("scheduler", BackgroundScheduler::toVar(processor->getScheduler().getStats()));
+            result->setProperty(run.name, juce::var(entry));
+
+            // Drain the last acknowledgement before the processor goes
+            processor->setHeadlessScriptSink(nullptr);
+            pumpFor(20);
+        }
+
+        result->setProperty("throttledSpeedup", throttledBlocksPerSecond / std::max(unthrottledBlocksPerSecond, 1.0e-3));
+        return juce::var(result);
+    }
+
+    //==============================================================================
+    // Queue a burst of sends through the outbox and wait until the server has
+    // confirmed them all, optionally with some of them failing and retried, then
+    // check that the server accepted them in the order they were queued.
+    juce::var benchmarkOutbox(Options const& o, MockChatServer& server)
+    {
+        auto processor = std::make_unique<EffectsPluginProcessor>();
+        processor->setApiBaseUrl(server.getBaseUrl().toStdString());
+
+        auto& outbox = processor->getChatHub().getOutbox();
+        server.setSendFailureInterval(o.sendFailureInterval);
+        server.takeAcceptedMessages();
+
+        auto const requestsBefore = server.getRequestsServed();
+        auto const sentBefore = outbox.getStats().sent;
+        auto const start = juce::Time::getHighResolutionTicks();
+
+        for (int i = 0; i < o.sends; ++i)
+            processor->sendMessageToAPI("bench-user", "Outbox message " + std::to_string(i));
+
+        auto const enqueueMs = elapsedMs(start);
+        auto const completed = pumpUntil([&] { return outbox.getStats().sent - sentBefore >= static_cast<uint64_t>(o.sends); }, 60000);
+        auto const ms = elapsedMs(start);
+        auto const stats = outbox.getStats();
+        auto const sent = std::max<uint64_t>(1, stats.sent - sentBefore);
+
+        server.setSendFailureInterval(0);
+
+        // Any message accepted where a different one was expected, or twice
+        auto const accepted = server.takeAcceptedMessages();
+        size_t outOfOrder = 0;
+
+        for (size_t i = 0; i < accepted.size(); ++i)
+            if (accepted[i] != "Outbox message " + std::to_string(i))
+                ++outOfOrder;
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("completed", completed);
+        result->setProperty("accepted", static_cast<juce::int64>(accepted.size()));
+        result->setProperty("outOfOrder", static_cast<juce::int64>(outOfOrder));
+        result->setProperty("inOrder", outOfOrder == 0 && accepted.size() == static_cast<size_t>(o.sends));
+        result->setProperty("sends", o.sends);
+        result->setProperty("failureInterval", o.sendFailureInterval);
+        result->setProperty("enqueueMs", enqueueMs);
+        result->setProperty("elapsedMs", ms);
+        result->setProperty("sendsPerSecond", static_cast<double>(sent) * 1000.0 / std::max(ms, 1.0e-3));
+        result->setProperty("meanLatencyMs", stats.totalLatencyMs / static_cast<double>(sent));
+        result->setProperty("maxLatencyMs", stats.maxLatencyMs);
+        result->setProperty("retries", static_cast<juce::int64>(stats.retries));
+        result->setProperty("requests", static_cast<juce::int64>(server.getRequestsServed() - requestsBefore));
+        return juce::var(result);
+    }
+
+    //==============================================================================
+    // Largest difference between each SIMD kernel and its scalar reference on
+    // the same stereo input.
+    juce::var checkKernels(Options const& o)
+    {
+        using namespace DspKernels;
+
+        constexpr int kChannels = 2;
+        constexpr int kSamples = 1024;
+
+        juce::AudioBuffer<float> input(kChannels, kSamples), expected(kChannels, kSamples), actual(kChannels, kSamples);
+        juce::Random random(3);
+
+        for (int ch = 0; ch < kChannels; ++ch)
+            for (int i = 0; i < kSamples; ++i)
+                input.setSample(ch, i, random.nextFloat() * 2.0f - 1.0f);
+
+        std::vector<Vec> frames(kSamples), dry(kSamples);
+        auto const coefficients = BiquadCoefficients::lowPass(o.sampleRate, 2000.0);
+
+        auto compare = [&](std::function<void(float*)> reference, std::function<void()> simd) {
+            expected.makeCopyOf(input);
+
+            for (int ch = 0; ch < kChannels; ++ch)
+                reference(expected.getWritePointer(ch));
+
+            interleave(input.getArrayOfReadPointers(), kChannels, 0, kSamples, frames.data());
+            interleave(input.getArrayOfReadPointers(), kChannels, 0, kSamples, dry.data());
+            simd();
+            deinterleave(frames.data(), kSamples, actual.getArrayOfWritePointers(), kChannels, 0);
+
+            float maxError = 0.0f;
+
+            for (int ch = 0; ch < kChannels; ++ch)
+                for (int i = 0; i < kSamples; ++i)
+                    maxError = std::max(maxError, std::abs(expected.getSample(ch, i) - actual.getSample(ch, i)));
+
+            return static_cast<double>(maxError);
+        };
+
+        auto* result = new juce::DynamicObject();
+
+        result->setProperty("gain", compare([](float* x) { Reference::gain(x, kSamples, 0.5f); },
+                                            [&] { gain(frames.data(), kSamples, 0.5f); }));
+
+        result->setProperty("biquad", compare([&](float* x) { float z1 = 0.0f, z2 = 0.0f; Reference::biquad(x, kSamples, coefficients, z1, z2); },
+                                              [&] { BiquadState state; biquad(frames.data(), kSamples, coefficients, state); }));
+
+        result->setProperty("saturate", compare([](float* x) { Reference::saturate(x, kSamples, 0.7f); },
+                                                [&] { saturate(frames.data(), kSamples, 0.7f); }));
+
+        // Mixes the signal with a half-level copy of itself
+        result->setProperty("mix", compare([](float* x) {
+                                               std::vector<float> half(x, x + kSamples);
+                                               Reference::gain(half.data(), kSamples, 0.5f);
+                                               Reference::mix(x, half.data(), kSamples, 0.3f);
+                                           },
+                                           [&] {
+                                               gain(dry.data(), kSamples, 0.5f);
+                                               mix(frames.data(), dry.data(), kSamples, 0.3f);
+                                           }));
+        return juce::var(result);
+    }
+
+    // Throughput of each kernel in channel-samples per second on one core, for
+    // a stereo signal at common block sizes. The SIMD kernels carry the two
+    // channels in lanes of one register; the references run channel by channel.
+    juce::var benchmarkKernels(Options const& o)
+    {
+        using namespace DspKernels;
+
+        constexpr int kChannels = 2;
+        juce::ScopedNoDenormals noDenormals;
+        juce::Random random(4);
+
+        auto const coefficients = BiquadCoefficients::lowPass(o.sampleRate, 2000.0);
+        auto const totalSamples = static_cast<juce::int64>(o.blocks) * 512;
+
+        juce::Array<juce::var> rows;
+
+        for (int blockSize : { 32, 64, 128, 256, 512, 1024 }) {
+            juce::AudioBuffer<float> planar(kChannels, blockSize), dryPlanar(kChannels, blockSize);
+
+            for (int ch = 0; ch < kChannels; ++ch)
+                for (int i = 0; i < blockSize; ++i)
+                    planar.setSample(ch, i, random.nextFloat() * 2.0f - 1.0f);
+
+            dryPlanar.makeCopyOf(planar);
+
+            auto const n = static_cast<size_t>(blockSize);
+            std::vector<Vec> frames(n), dry(n);
+            interleave(planar.getArrayOfReadPointers(), kChannels, 0, n, frames.data());
+            interleave(planar.getArrayOfReadPointers(), kChannels, 0, n, dry.data());
+
+            auto const iterations = std::max<juce::int64>(1, totalSamples / blockSize);
+
+            // A negative unity gain keeps repeated runs bounded and denormal-free
+            auto measure = [&](auto&& fn) {
+                auto const start = juce::Time::getHighResolutionTicks();
+
+                for (juce::int64 it = 0; it < iterations; ++it)
+                    fn();
+
+                auto const seconds = elapsedMs(start) / 1000.0;
+                return static_cast<double>(iterations * blockSize * kChannels) / std::max(seconds, 1.0e-9);
+            };
+
+            BiquadState state;
+            float z1[kChannels] = {}, z2[kChannels] = {};
+
+            auto* simd = new juce::DynamicObject();
+            simd->setProperty("gain", measure([&] { gain(frames.data(), n, -1.0f); }));
+            simd->setProperty("biquad", measure([&] { biquad(frames.data(), n, coefficients, state); }));
+            simd->setProperty("saturate", measure([&] { saturate(frames.data(), n, 0.5f); }));
+            simd->setProperty("mix", measure([&] { mix(frames.data(), dry.data(), n, 0.5f); }));
+            simd->setProperty("interleave", measure([&] {
+                interleave(planar.getArrayOfReadPointers(), kChannels, 0, n, frames.data());
+                deinterleave(frames.data(), n, planar.getArrayOfWritePointers(), kChannels, 0);
+            }));
+
+            auto* scalar = new juce::DynamicObject();
+            scalar->setProperty("gain", measure([&] {
+                for (int ch = 0; ch < kChannels; ++ch)
+                    Reference::gain(planar.getWritePointer(ch), n, -1.0f);
+            }));
+            scalar->setProperty("biquad", measure([&] {
+                for (int ch = 0; ch < kChannels; ++ch)
+                    Reference::biquad(planar.getWritePointer(ch), n, coefficients, z1[ch], z2[ch]);
+            }));
+            scalar->setProperty("saturate", measure([&] {
+                for (int ch = 0; ch < kChannels; ++ch)
+                    Reference::saturate(planar.getWritePointer(ch), n, 0.5f);
+            }));
+            scalar->setProperty("mix", measure([&] {
+                for (int ch = 0; ch < kChannels; ++ch)
+                    Reference::mix(planar.getWritePointer(ch), dryPlanar.getReadPointer(ch), n, 0.5f);
+            }));
+
+            auto* row = new juce::DynamicObject();
+            row->setProperty("blockSize", blockSize);
+            row->setProperty("simdSamplesPerSecond", juce::var(simd));
+            row->setProperty("scalarSamplesPerSecond", juce::var(scalar));
+            rows.add(juce::var(row));
+        }
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("lanes", static_cast<int>(kLanes));
+        result->setProperty("channels", kChannels);
+        result->setProperty("maxError", checkKernels(o));
+        result->setProperty("blockSizes", rows);
+        return juce::var(result);
+    }
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    // Provides the message thread that timers and posted callbacks run on
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    auto const options = parseOptions(juce::ArgumentList(argc, argv));
+
+    MockChatServer server;
+
+    if (!server.start()) {
+        std::cerr << "Could not start the mock chat server" << std::endl;
+        return 1;
+    }
+
+    auto* config = new juce::DynamicObject();
+    config->setProperty("blocks", options.blocks);
+    config->setProperty("blockSize", options.blockSize);
+    config->setProperty("sampleRate", options.sampleRate);
+    config->setProperty("messages", options.messages);
+    config->setProperty("instances", options.instances);
+    config->setProperty("startupInstances", options.startupInstances);
+    config->setProperty("parameters", options.parameters);
+    config->setProperty("sends", options.sends);
+    config->setProperty("captureSeconds", options.captureSeconds);
+    config->setProperty("jsHeapLimitMb", options.jsHeapLimitMb);
+    config->setProperty("searchMessages", options.searchMessages);
+    config->setProperty("pageLoads", options.pageLoads);
+    config->setProperty("serverDelayMs", options.serverDelayMs);
+    config->setProperty("deliveryProbes", options.deliveryProbes);
+    config->setProperty("idleSeconds", options.idleSeconds);
+
+    if (options.trace != juce::File())
+        Trace::start();
+
+    auto* results = new juce::DynamicObject();
+    results->setProperty("schema", 1);
+    results->setProperty("config", juce::var(config));
+    results->setProperty("startup", benchmarkStartup(options, server));
+    results->setProperty("assets", benchmarkAssets(options));
+    results->setProperty("javascriptMemory", benchmarkJavaScriptMemory(options, server));
+    results->setProperty("processBlock", benchmarkProcessBlock(options, server));
+    results->setProperty("parameterBank", benchmarkParameterBank(options));
+    results->setProperty("kernels", benchmarkKernels(options));
+    results->setProperty("slowServer", benchmarkSlowServer(options, server));
+    results->setProperty("delivery", benchmarkDelivery(options));
+    results->setProperty("messagePipeline", benchmarkMessagePipeline(options, server));
+    results->setProperty("search", benchmarkSearch(options));
+    results->setProperty("outbox", benchmarkOutbox(options, server));
+    results->setProperty("capture", benchmarkCapture(options, server));
+    results->setProperty("offlineRender", benchmarkOfflineRender(options, server));
+
+    if (options.trace != juce::File()) {
+        Trace::stop();
+
+        auto const stats = Trace::getStats();
+        auto* trace = new juce::DynamicObject();
+        trace->setProperty("file", options.trace.getFullPathName());
+        trace->setProperty("written", Trace::writeChromeJson(options.trace));
+        trace->setProperty("threads", stats.threads);
+        trace->setProperty("eventsRecorded", static_cast<juce::int64>(stats.eventsRecorded));
+        trace->setProperty("eventsDropped", static_cast<juce::int64>(stats.eventsDropped));
+        results->setProperty("trace", juce::var(trace));
+    }
+
+    auto json = juce::JSON::toString(juce::var(results));
+
+    if (options.output != juce::File()) {
+        if (!options.output.replaceWithText(json)) {
+            std::cerr << "Could not write " << options.output.getFullPathName() << std::endl;
+            return 1;
+        }
+    } else {
+        std::cout << json << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,300 @@
+#include "MockChatServer.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+
+//==============================================================================
+class MockChatServer::Connection : public juce::Thread
+{
+public:
+    Connection(MockChatServer& s, std::unique_ptr<juce::StreamingSocket> connection)
+        : juce::Thread("MockChatServer connection"),
+          server(s),
+          socket(std::move(connection))
+    {
+    }
+
+    ~Connection() override
+    {
+        stopThread(2000);
+    }
+
+    void run() override
+    {
+        server.serve(*socket);
+        socket->close();
+    }
+
+private:
+    MockChatServer& server;
+    std::unique_ptr<juce::StreamingSocket> socket;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Connection)
+};
+
+//==============================================================================
+MockChatServer::MockChatServer(int numMessages)
+    : juce::Thread("MockChatServer"),
+      messagesPerResponse(numMessages)
+{
+}
+
+MockChatServer::~MockChatServer()
+{
+    signalThreadShouldExit();
+
+    // Unblocks waitForNextConnection()
+    listener.close();
+    stopThread(2000);
+
+    // Every connection loop watches this thread's exit flag, so they are all
+    // on their way out by now
+    connections.clear();
+}
+
+bool MockChatServer::start()
+{
+    if (!listener.createListener(0, "127.0.0.1"))
+        return false;
+
+    startThread();
+    return true;
+}
+
+//==============================================================================
+void MockChatServer::run()
+{
+    while (!threadShouldExit())
+    {
+        std::unique_ptr<juce::StreamingSocket> socket(listener.waitForNextConnection());
+
+        if (socket == nullptr)
+            continue;
+
+        connections.erase(std::remove_if(connections.begin(), connections.end(), [](auto const& c) {
+                              return !c->isThreadRunning();
+                          }),
+                          connections.end());
+
+        connections.push_back(std::make_unique<Connection>(*this, std::move(socket)));
+        connections.back()->startThread();
+    }
+}
+
+void MockChatServer::serve(juce::StreamingSocket& connection)
+{
+    std::string buffer;
+    char chunk[4096];
+
+    while (!threadShouldExit())
+    {
+        auto headerEnd = buffer.find("\r\n\r\n");
+
+        if (headerEnd == std::string::npos) {
+            if (connection.waitUntilReady(true, 100) == 0)
+                continue;
+
+            auto numRead = connection.read(chunk, sizeof(chunk), false);
+
+            if (numRead <= 0)
+                return;
+
+            buffer.append(chunk, static_cast<size_t>(numRead));
+            continue;
+        }
+
+        auto headers = juce::String(buffer.substr(0, headerEnd)).toLowerCase();
+        auto contentLengthStart = headers.indexOf("content-length:");
+        size_t contentLength = 0;
+
+        if (contentLengthStart >= 0)
+            contentLength = static_cast<size_t>(headers.substring(contentLengthStart + 15).getLargeIntValue());
+
+        auto const requestSize = headerEnd + 4 + contentLength;
+
+        while (buffer.size() < requestSize && !threadShouldExit()) {
+            auto numRead = connection.read(chunk, sizeof(chunk), false);
+
+            if (numRead <= 0)
+                return;
+
+            buffer.append(chunk, static_cast<size_t>(numRead));
+        }
+
+        auto requestBody = buffer.substr(headerEnd + 4, contentLength);
+        buffer.erase(0, requestSize);
+
+        if (headers.startsWith("get /messages/stream")) {
+            auto query = headers.fromFirstOccurrenceOf("fromtimestamp=", false, false);
+            ++requestsServed;
+            stream(connection, query.isEmpty() ? 0 : query.getLargeIntValue());
+            return;
+        }
+
+        std::string body = "{\"messages\":[]}";
+        std::string status = "200 OK";
+
+        if (headers.startsWith("post /messages/send")) {
+            auto const n = ++sendsReceived;
+            auto const interval = sendFailureInterval.load();
+
+            if (interval > 0 && n % static_cast<uint64_t>(interval) == 0) {
+                status = "503 Service Unavailable";
+            } else {
+                auto const json = juce::JSON::parse(juce::String(requestBody));
+                auto const text = json["message"].toString().toStdString();
+
+                {
+                    const juce::ScopedLock sl(acceptedLock);
+                    acceptedMessages.push_back(text);
+                }
+
+                ++sendsAccepted;
+                postMessage(json["nickname"].toString().toStdString(), text);
+            }
+        } else if (headers.startsWith("post /messages/get")) {
+            int64_t fromTimestamp = 0;
+            auto key = requestBody.find("\"fromTimestamp\":");
+
+            if (key != std::string::npos)
+                fromTimestamp = std::strtoll(requestBody.c_str() + key + 16, nullptr, 10);
+
+            if (messagesPerResponse > 0) {
+                body = makeMessagesBody(fromTimestamp);
+            } else {
+                const juce::ScopedLock sl(postedLock);
+                body = makePostedBody(fromTimestamp);
+            }
+        }
+
+        // Slept in slices, so that shutting down is not held up by a long delay
+        auto const respondAtMs = juce::Time::getMillisecondCounter() + static_cast<juce::uint32>(responseDelayMs.load());
+
+        while (static_cast<juce::int32>(juce::Time::getMillisecondCounter() - respondAtMs) < 0 && !threadShouldExit())
+            juce::Thread::sleep(10);
+
+        std::string response = "HTTP/1.1 " + status + "\r\n"
+                               "Content-Type: application/json\r\n"
+                               "Connection: keep-alive\r\n"
+                               "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+
+        if (connection.write(response.data(), static_cast<int>(response.size())) != static_cast<int>(response.size()))
+            return;
+
+        ++requestsServed;
+    }
+}
+
+// Sends the backlog, then holds the connection open; postMessage() writes each
+// new message to it as an event.
+void MockChatServer::stream(juce::StreamingSocket& connection, int64_t fromTimestamp)
+{
+    {
+        const juce::ScopedLock sl(postedLock);
+
+        std::string head = "HTTP/1.1 200 OK\r\n"
+                           "Content-Type: text/event-stream\r\n"
+                           "Cache-Control: no-cache\r\n"
+                           "Connection: keep-alive\r\n\r\n";
+
+        auto const backlog = makePostedBody(fromTimestamp);
+
+        if (backlog != "{\"messages\":[]}")
+            head += "event: messages\ndata: " + backlog + "\n\n";
+
+        if (connection.write(head.data(), static_cast<int>(head.size())) != static_cast<int>(head.size()))
+            return;
+
+        openStreams.push_back(&connection);
+    }
+
+    // Nothing more is read; this only notices the client hanging up
+    while (!threadShouldExit())
+    {
+        auto const ready = connection.waitUntilReady(true, 100);
+        char c = 0;
+
+        if (ready < 0 || (ready > 0 && connection.read(&c, 1, false) <= 0))
+            break;
+    }
+
+    const juce::ScopedLock sl(postedLock);
+    openStreams.erase(std::remove(openStreams.begin(), openStreams.end(), &connection), openStreams.end());
+}
+
+std::vector<std::string> MockChatServer::takeAcceptedMessages()
+{
+    const juce::ScopedLock sl(acceptedLock);
+    return std::exchange(acceptedMessages, {});
+}
+
+void MockChatServer::postMessage(std::string const& nickname, std::string const& text)
+{
+    const juce::ScopedLock sl(postedLock);
+
+    // Strictly increasing, so that it works as a cursor
+    auto createdAt = static_cast<int64_t>(juce::Time::currentTimeMillis());
+
+    if (!postedMessages.empty())
+        createdAt = std::max(createdAt, postedMessages.back().createdAt + 1);
+
+    auto* message = new juce::DynamicObject();
+    message->setProperty("nickname", juce::String(nickname));
+    message->setProperty("message", juce::String(text));
+    message->setProperty("createdAt", static_cast<juce::int64>(createdAt));
+
+    postedMessages.push_back({ createdAt, juce::JSON::toString(juce::var(message), true).toStdString() });
+
+    // A stream whose client has gone drops out once its thread notices
+    auto const event = "event: messages\ndata: {\"messages\":[" + postedMessages.back().json + "]}\n\n";
+
+    for (auto* stream : openStreams)
+        stream->write(event.data(), static_cast<int>(event.size()));
+}
+
+int MockChatServer::getNumOpenStreams() const
+{
+    const juce::ScopedLock sl(postedLock);
+    return static_cast<int>(openStreams.size());
+}
+
+std::string MockChatServer::makeMessagesBody(int64_t fromTimestamp) const
+{
+    std::string body = "{\"messages\":[";
+
+    for (int i = 0; i < messagesPerResponse; ++i) {
+        auto createdAt = fromTimestamp + 1 + i;
+
+        if (i > 0)
+            body += ',';
+
+        body += "{\"nickname\":\"bench-user-" + std::to_string(createdAt % 8) + "\","
+                "\"message\":\"Benchmark message " + std::to_string(createdAt) + " with a bit of text, an \\\"escape\\\" and caf\\u00e9\","
+                "\"createdAt\":" + std::to_string(createdAt) + "}";
+    }
+
+    body += "]}";
+    return body;
+}
+
+// Called with postedLock held
+std::string MockChatServer::makePostedBody(int64_t fromTimestamp) const
+{
+    std::string body = "{\"messages\":[";
+    bool first = true;
+
+    for (auto const& message : postedMessages) {
+        if (message.createdAt <= fromTimestamp)
+            continue;
+
+        if (!first)
+            body += ',';
+
+        body += message.json;
+        first = false;
+    }
+
+    body += "]}";
+    return body;
+}
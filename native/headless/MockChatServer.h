@@ -0,0 +1,95 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+//==============================================================================
+// A minimal in-process stand-in for the chat API, for the headless benchmarks.
+//
+// Listens on an ephemeral localhost port and serves each connection on its own
+// thread, over keep-alive HTTP/1.1 like the real server. POST /messages/send is
+// counted and, if asked to, every nth one fails with a 503 to exercise
+// retries; the text of each accepted one is kept, in arrival order, and it is
+// posted like a message from postMessage().
+//
+// POST /messages/get answers with a fixed-size batch of synthetic messages
+// newer than the requested timestamp or, when the batch size is 0, with the
+// posted messages newer than it. GET /messages/stream is a Server-Sent Events
+// stream that starts with the posted messages newer than its fromTimestamp
+// and then pushes each one as it is posted. Every other request gets an empty
+// message list. Every response can be held back for a while, to stand in for
+// a slow server.
+class MockChatServer : private juce::Thread
+{
+public:
+    //==============================================================================
+    explicit MockChatServer(int messagesPerResponse = 50);
+    ~MockChatServer() override;
+
+    // Returns false if no port could be bound
+    bool start();
+
+    int getPort() const { return listener.getBoundPort(); }
+    juce::String getBaseUrl() const { return "http://127.0.0.1:" + juce::String(getPort()); }
+
+    uint64_t getRequestsServed() const { return requestsServed.load(); }
+    uint64_t getSendsAccepted() const { return sendsAccepted.load(); }
+
+    // 0 accepts every send
+    void setSendFailureInterval(int n) { sendFailureInterval = n; }
+
+    // Holds back every response for this long; 0 answers straight away
+    void setResponseDelayMs(int ms) { responseDelayMs = ms; }
+
+    // The texts of the sends accepted since the last call, oldest first
+    std::vector<std::string> takeAcceptedMessages();
+
+    // Posts a message as another user would, and pushes it to every open stream
+    void postMessage(std::string const& nickname, std::string const& text);
+
+    int getNumOpenStreams() const;
+
+private:
+    //==============================================================================
+    class Connection;
+
+    void run() override;
+    void serve(juce::StreamingSocket& connection);
+    void stream(juce::StreamingSocket& connection, int64_t fromTimestamp);
+    std::string makeMessagesBody(int64_t fromTimestamp) const;
+    std::string makePostedBody(int64_t fromTimestamp) const;
+
+    //==============================================================================
+    int const messagesPerResponse;
+    juce::StreamingSocket listener;
+    std::atomic<uint64_t> requestsServed { 0 };
+    std::atomic<uint64_t> sendsReceived { 0 };
+    std::atomic<uint64_t> sendsAccepted { 0 };
+    std::atomic<int> sendFailureInterval { 0 };
+    std::atomic<int> responseDelayMs { 0 };
+
+    juce::CriticalSection acceptedLock;
+    std::vector<std::string> acceptedMessages;
+
+    struct PostedMessage
+    {
+        int64_t createdAt;
+        std::string json;
+    };
+
+    // Guards the posted messages and the open streams, so that a stream never
+    // misses a message posted while it sends its backlog
+    juce::CriticalSection postedLock;
+    std::vector<PostedMessage> postedMessages;
+    std::vector<juce::StreamingSocket*> openStreams;
+
+    // Only touched by the accepting thread, and by the destructor once it stops
+    std::vector<std::unique_ptr<Connection>> connections;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MockChatServer)
+};
@@ -0,0 +1,75 @@
+// Compiles dsp.main.js to QuickJS bytecode for the plugin to load at startup.
+//
+//   dsp-bytecode-compiler <input.js> <output.qjsbc>
+//
+// It is built against the same choc QuickJS sources as the plugin, so the
+// bytecode matches the engine that reads it back.
+#include <choc_javascript_QuickJS.h>
+
+#include "../ScriptBytecode.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+namespace quickjs = choc::javascript::quickjs;
+
+int main(int argc, char** argv)
+{
+    if (argc != 3) {
+        std::fprintf(stderr, "usage: %s <input.js> <output.qjsbc>\n", argv[0]);
+        return 2;
+    }
+
+    std::ifstream in(argv[1], std::ios::binary);
+
+    if (!in) {
+        std::fprintf(stderr, "cannot read %s\n", argv[1]);
+        return 1;
+    }
+
+    std::string source((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    auto* runtime = quickjs::JS_NewRuntime();
+    auto* context = quickjs::JS_NewContext(runtime);
+
+    // The bundle is a classic script (esbuild's iife output), evaluated globally
+    auto compiled = quickjs::JS_Eval(context, source.c_str(), source.size(), "dsp.main.js",
+                                     JS_EVAL_TYPE_GLOBAL | JS_EVAL_FLAG_COMPILE_ONLY);
+    int result = 1;
+
+    if (quickjs::JS_IsException(compiled)) {
+        auto error = quickjs::JS_GetException(context);
+        auto* message = quickjs::JS_ToCString(context, error);
+        std::fprintf(stderr, "%s: %s\n", argv[1], message != nullptr ? message : "compile error");
+        quickjs::JS_FreeCString(context, message);
+        quickjs::JS_FreeValue(context, error);
+    } else {
+        size_t size = 0;
+        auto* bytecode = quickjs::JS_WriteObject(context, &size, compiled, JS_WRITE_OBJ_BYTECODE);
+
+        if (bytecode != nullptr) {
+            std::vector<uint8_t> container;
+            ScriptBytecode::wrap(ScriptBytecode::hashSource(source), bytecode, size, container);
+            quickjs::js_free(context, bytecode);
+
+            std::ofstream out(argv[2], std::ios::binary | std::ios::trunc);
+            out.write(reinterpret_cast<const char*>(container.data()), static_cast<std::streamsize>(container.size()));
+
+            if (out) {
+                std::printf("%s: %zu bytes of bytecode\n", argv[2], size);
+                result = 0;
+            } else {
+                std::fprintf(stderr, "cannot write %s\n", argv[2]);
+            }
+        } else {
+            std::fprintf(stderr, "JS_WriteObject failed\n");
+        }
+    }
+
+    quickjs::JS_FreeValue(context, compiled);
+    quickjs::JS_FreeContext(context);
+    quickjs::JS_FreeRuntime(runtime);
+    return result;
+}
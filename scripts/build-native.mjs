@@ -15,6 +15,7 @@ cd(buildDir);
 
 let buildType = argv.dev ? 'Debug' : 'Release';
 let devFlag = argv.dev ? '-DELEM_DEV_LOCALHOST=1' : '';
+let headlessFlag = argv.headless ? '-DELEM_BUILD_HEADLESS=ON' : '';
 
-await $`cmake -DCMAKE_BUILD_TYPE=${buildType} -DCMAKE_INSTALL_PREFIX=./out/ -DCMAKE_OSX_DEPLOYMENT_TARGET=10.15 ${devFlag} ../..`;
+await $`cmake -DCMAKE_BUILD_TYPE=${buildType} -DCMAKE_INSTALL_PREFIX=./out/ -DCMAKE_OSX_DEPLOYMENT_TARGET=10.15 ${devFlag} ${headlessFlag} ../..`;
 await $`cmake --build . --config ${buildType} -j 4`;
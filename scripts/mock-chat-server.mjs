@@ -0,0 +1,119 @@
+#!/usr/bin/env node
+
+// A local stand-in for the chat API, for developing and measuring the native
+// transports without the hosted server.
+//
+//   node scripts/mock-chat-server.mjs [--port 8787] [--latency 0]
+//
+// Point the plugin at it with ELEM_CHAT_API_URL=http://127.0.0.1:8787. Besides the
+// real endpoints it serves GET /stats, which reports request counts per endpoint so
+// the idle request rate of each transport can be compared.
+
+import http from 'node:http';
+
+function arg(name, fallback) {
+  const i = process.argv.indexOf(`--${name}`);
+  return i > 0 && i + 1 < process.argv.length ? process.argv[i + 1] : fallback;
+}
+
+const port = Number(arg('port', 8787));
+const latencyMs = Number(arg('latency', 0));
+
+const messages = [];
+const streams = new Set();
+const stats = { send: 0, get: 0, stream: 0, streamsOpen: 0, startedAt: Date.now() };
+
+function messagesSince(fromTimestamp) {
+  return messages.filter(m => m.createdAt > fromTimestamp);
+}
+
+function readBody(req) {
+  return new Promise((resolve) => {
+    let body = '';
+    req.on('data', chunk => { body += chunk; });
+    req.on('end', () => {
+      try {
+        resolve(body.length > 0 ? JSON.parse(body) : {});
+      } catch (e) {
+        resolve({});
+      }
+    });
+  });
+}
+
+function sendJson(res, value) {
+  res.writeHead(200, { 'Content-Type': 'application/json' });
+  res.end(JSON.stringify(value));
+}
+
+function writeEvent(res, list) {
+  res.write(`event: messages\ndata: ${JSON.stringify({ messages: list })}\n\n`);
+}
+
+async function handle(req, res) {
+  const url = new URL(req.url, `http://${req.headers.host}`);
+
+  if (latencyMs > 0) {
+    await new Promise(resolve => setTimeout(resolve, latencyMs));
+  }
+
+  if (req.method === 'POST' && url.pathname === '/messages/send') {
+    stats.send++;
+    const { nickname = '', message = '' } = await readBody(req);
+    const last = messages.length > 0 ? messages[messages.length - 1].createdAt : 0;
+
+    // Keep createdAt strictly increasing so it works as a cursor
+    const entry = { nickname, message, createdAt: Math.max(Date.now(), last + 1) };
+    messages.push(entry);
+
+    for (const stream of streams) {
+      writeEvent(stream, [entry]);
+    }
+
+    return sendJson(res, { messages: [entry] });
+  }
+
+  if (req.method === 'POST' && url.pathname === '/messages/get') {
+    stats.get++;
+    const { fromTimestamp = 0 } = await readBody(req);
+    return sendJson(res, { messages: messagesSince(Number(fromTimestamp)) });
+  }
+
+  if (req.method === 'GET' && url.pathname === '/messages/stream') {
+    stats.stream++;
+    stats.streamsOpen++;
+
+    res.writeHead(200, {
+      'Content-Type': 'text/event-stream',
+      'Cache-Control': 'no-cache',
+      'Connection': 'keep-alive',
+    });
+
+    const backlog = messagesSince(Number(url.searchParams.get('fromTimestamp') || 0));
+    if (backlog.length > 0) {
+      writeEvent(res, backlog);
+    }
+
+    streams.add(res);
+    const heartbeat = setInterval(() => res.write(': ping\n\n'), 15000);
+
+    req.on('close', () => {
+      clearInterval(heartbeat);
+      streams.delete(res);
+      stats.streamsOpen--;
+    });
+
+    return;
+  }
+
+  if (req.method === 'GET' && url.pathname === '/stats') {
+    return sendJson(res, { ...stats, messages: messages.length, uptimeMs: Date.now() - stats.startedAt });
+  }
+
+  res.writeHead(404);
+  res.end();
+}
+
+http.createServer(handle).listen(port, '127.0.0.1', () => {
+  console.log(`Mock chat server listening on http://127.0.0.1:${port} (latency ${latencyMs} ms)`);
+});
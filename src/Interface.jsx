@@ -1,10 +1,11 @@
-import React, { useState, useRef, useEffect } from 'react';
+import React, { useState, useRef, useEffect, useLayoutEffect } from 'react';
 import { XCircleIcon, XMarkIcon } from '@heroicons/react/20/solid';
 
 import SendButton from './SendButton';
 import DragBar from './DragBar';
 import MessageBox from './MessageBox';
 import ChatHistory from './ChatHistory';
+import Knob from './Knob';
 
 // Logo component (kept inline for simplicity, but you could move it to a separate file)
 const Logo = (props) => (
@@ -51,9 +52,103 @@ function ErrorAlert({ message, reset }) {
   )
 }
 
+function ParameterKnob({ label, paramId, value, onChange }) {
+  return (
+    <div className="flex flex-col items-center">
+      <Knob
+        className="h-12 w-12"
+        value={value}
+        onChange={(v) => onChange(paramId, v)}
+        meterColor="#EC4899"
+        knobColor="#64748B"
+        thumbColor="#F1F5F9" />
+      <div className="text-xs uppercase">{label}</div>
+    </div>
+  );
+}
+
+// DSP load of processBlock against its real-time budget, and whether background
+// work is being held back for it; click to reset
+function PerformanceReadout({ stats, onReset }) {
+  if (!stats || stats.blocks === 0)
+    return null;
+
+  return (
+    <button type="button" onClick={onReset} className="block text-xs text-slate-500 tabular-nums">
+      DSP {stats.avgLoad.toFixed(1)}% &middot; p99 {stats.p99Load.toFixed(0)}% &middot; {stats.overruns} overruns
+      {stats.scheduler && stats.scheduler.mode !== 'normal' && <> &middot; {stats.scheduler.mode}</>}
+    </button>
+  );
+}
+
+// Heap of this instance's script engine; click to collect garbage
+function ScriptMemoryReadout({ stats, onCollect }) {
+  if (!stats || !stats.javascript)
+    return null;
+
+  const { heapBytes, memoryLimitBytes, gcRuns } = stats.javascript;
+  const mb = (bytes) => (bytes / (1024 * 1024)).toFixed(1);
+
+  return (
+    <button type="button" onClick={onCollect} className="block text-xs text-slate-500 tabular-nums">
+      JS {mb(heapBytes)}{memoryLimitBytes > 0 ? ` / ${mb(memoryLimitBytes)}` : ''} MB &middot; {gcRuns} GCs
+    </button>
+  );
+}
+
+// Starts and stops a trace session; the last trace file is shown as a tooltip
+function TraceButton({ trace, onToggle }) {
+  return (
+    <button type="button" onClick={onToggle} title={trace.file} className="block text-xs text-slate-500">
+      {trace.active ? 'Stop trace' : 'Trace'}
+    </button>
+  );
+}
+
+// Records the next few seconds of output and posts them to the chat
+function ShareAudioButton({ capturing, onShare }) {
+  return (
+    <button type="button" onClick={onShare} disabled={capturing} className="block text-xs text-slate-500 disabled:text-pink-500">
+      {capturing ? 'Recording\u2026' : 'Share 5s of audio'}
+    </button>
+  );
+}
+
+// Filters the chat; facets narrow the search to one sender
+function SearchBar({ search, onSearch }) {
+  const results = search.results;
+
+  return (
+    <div className="px-4 py-2 text-xs text-slate-500">
+      <input
+        type="search"
+        value={search.text}
+        onChange={e => onSearch(e.target.value, search.nickname)}
+        placeholder="Search messages"
+        className="w-full bg-transparent border-b border-slate-700 text-slate-300 focus:outline-none" />
+      {results && (
+        <div className="flex flex-wrap gap-2 pt-1">
+          <span>{results.total}{results.exact ? '' : '+'} found in {Math.round(results.elapsedUs)}&micro;s</span>
+          {results.facets.map(f => (
+            <button
+              key={f.nickname}
+              type="button"
+              onClick={() => onSearch(search.text, search.nickname === f.nickname ? '' : f.nickname)}
+              className={search.nickname === f.nickname ? 'text-pink-500' : 'text-slate-500'}>
+              {f.nickname} ({f.count})
+            </button>
+          ))}
+        </div>
+      )}
+    </div>
+  );
+}
+
 export default function Interface(props) {
   const [chatWidth, setChatWidth] = useState(300); // Default width
   const chatHistoryRef = useRef(null);
+  const atBottomRef = useRef(true);
+  const scrollSnapshotRef = useRef({ firstSeq: undefined, scrollHeight: 0 });
 
   const handleSend = (message) => {
     props.sendMessage(message);
@@ -66,26 +161,67 @@ export default function Interface(props) {
     setChatWidth(newWidth);
   };
 
-  useEffect(() => {
-    if (chatHistoryRef.current) {
-      chatHistoryRef.current.scrollTop = chatHistoryRef.current.scrollHeight;
+  // Follow new messages only while the user is at the bottom, and keep the view
+  // steady when an older page is prepended above it.
+  useLayoutEffect(() => {
+    const el = chatHistoryRef.current;
+    if (!el) return;
+
+    const firstSeq = props.messages.length > 0 ? props.messages[0].seq : undefined;
+    const previous = scrollSnapshotRef.current;
+
+    if (atBottomRef.current) {
+      el.scrollTop = el.scrollHeight;
+    } else if (firstSeq !== previous.firstSeq && props.messages.some(m => m.seq === previous.firstSeq)) {
+      el.scrollTop += el.scrollHeight - previous.scrollHeight;
+    }
+
+    scrollSnapshotRef.current = { firstSeq, scrollHeight: el.scrollHeight };
+  }, [props.messages, props.search.results]);
+
+  const handleScroll = (e) => {
+    const el = e.currentTarget;
+    atBottomRef.current = el.scrollHeight - el.scrollTop - el.clientHeight < 16;
+
+    if (el.scrollTop < 48) {
+      props.loadOlderMessages();
+    } else if (atBottomRef.current) {
+      props.loadNewestMessages();
     }
-  }, [props.messages]);
+  };
 
   return (
     <div className="w-full h-screen min-w-[492px] min-h-[238px]  bg-black flex flex-col overflow-hidden">
       <div className="h-1/5 flex justify-between items-center text-md text-slate-400 select-none p-8">
         <Logo className="h-8 w-auto text-slate-100" />
+        <div className="flex gap-4">
+          <ParameterKnob label="Gain" paramId="gain" value={props.parameters.gain} onChange={props.setParameterValue} />
+          <ParameterKnob label="Pan" paramId="pan" value={props.parameters.pan} onChange={props.setParameterValue} />
+          <ParameterKnob label="Drive" paramId="drive" value={props.parameters.drive} onChange={props.setParameterValue} />
+          <ParameterKnob label="Tone" paramId="tone" value={props.parameters.tone} onChange={props.setParameterValue} />
+          <ParameterKnob label="Mix" paramId="mix" value={props.parameters.mix} onChange={props.setParameterValue} />
+        </div>
         <div>
           <span className="font-bold">HERE VST</span> &middot; {__BUILD_DATE__} 
+          <PerformanceReadout stats={props.performance} onReset={props.resetPerformanceStats} />
+          <ScriptMemoryReadout stats={props.performance} onCollect={props.collectGarbage} />
+          <TraceButton trace={props.trace} onToggle={props.toggleTrace} />
+          <ShareAudioButton capturing={props.capturing} onShare={() => props.shareAudio(5)} />
         </div>
       </div>
       <div className="flex flex-1 overflow-hidden">
         <div className="flex-grow flex flex-col">
           {props.error && (<ErrorAlert message={props.error.message} reset={props.resetErrorState} />)}
-          <div ref={chatHistoryRef} className="flex-grow overflow-y-auto">
-            <ChatHistory messages={props.messages} />
-          </div>
+          <SearchBar search={props.search} onSearch={props.searchMessages} />
+          {props.search.results ? (
+            <div className="flex-grow overflow-y-auto">
+              <ChatHistory messages={props.search.results.messages} />
+            </div>
+          ) : (
+            <div ref={chatHistoryRef} onScroll={handleScroll} className="flex-grow overflow-y-auto">
+              <ChatHistory messages={props.messages} />
+            </div>
+          )}
           <MessageBox onSend={handleSend} />
         </div>
         <DragBar onResize={handleResize} />
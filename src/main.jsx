@@ -7,9 +7,27 @@ import createStore from 'zustand/vanilla'
 
 import './index.css'
 
+// Only a window of the chat is kept in memory here; native holds the full history
+// and hands out pages of it on request as the user scrolls.
+const kMaxMessagesInMemory = 200;
+const kPageSize = 50;
+
 const store = createStore((set) => ({
   messages: [],
+  hasOlder: false,
+  hasNewer: false,
+  loadingOlder: false,
   currentUser: 'Ostin',
+  // Normalised 0..1 values keyed by parameter id; native is the source of truth
+  parameters: { gain: 0.5, pan: 0.5, drive: 0, tone: 1, mix: 0 },
+  // processBlock timing and script memory, polled from native once a second
+  performance: null,
+  // Process-wide trace session; file is where the last one was written
+  trace: { active: false, file: '' },
+  // True while native is recording a snippet to share
+  capturing: false,
+  // Chat search; results is null while no search is active
+  search: { text: '', nickname: '', results: null },
   setMessages: (newMessages) => set({ messages: newMessages }),
   addMessage: (message) => set(state => ({ messages: [...state.messages, message] })),
 }));
@@ -45,15 +63,178 @@ globalThis.__receiveStateChange__ = function(state) {
   }));
 };
 
-globalThis.__receiveMessage__ = function(serializedMessage) {
-  const message = JSON.parse(serializedMessage);
-  store.getState().addMessage({
+function toUiMessage(message) {
+  return {
+    seq: message.seq,
     sender: message.sender,
     text: message.text,
-    timestamp: message.timestamp
+    timestamp: message.timestamp,
+  };
+}
+
+// Native coalesces everything that arrived within a frame into one call here, and
+// waits for our ack before sending the next batch.
+globalThis.__receiveMessages__ = function(messages) {
+  store.setState(state => {
+    // While scrolled back the window does not reach the live end; the newest page
+    // is requested again when the user returns to the bottom.
+    if (state.hasNewer)
+      return {};
+
+    const all = state.messages.concat(messages.map(toUiMessage));
+    const kept = all.length > kMaxMessagesInMemory ? all.slice(all.length - kMaxMessagesInMemory) : all;
+
+    return {
+      messages: kept,
+      hasOlder: state.hasOlder || kept.length < all.length,
+    };
+  });
+
+  requestAnimationFrame(() => {
+    if (typeof globalThis.__postNativeMessage__ === 'function') {
+      globalThis.__postNativeMessage__('messagesReceived');
+    }
+  });
+};
+
+// Answers a getMessages request. beforeSeq 0 is the newest page and replaces the
+// window; anything else is older history and is prepended.
+globalThis.__receiveMessagePage__ = function(page) {
+  const received = page.messages.map(toUiMessage);
+
+  if (page.beforeSeq === 0) {
+    store.setState({ messages: received, hasOlder: page.hasMore, hasNewer: false, loadingOlder: false });
+    return;
+  }
+
+  store.setState(state => {
+    const all = received.concat(state.messages);
+    const kept = all.length > kMaxMessagesInMemory ? all.slice(0, kMaxMessagesInMemory) : all;
+
+    return {
+      messages: kept,
+      hasOlder: page.hasMore,
+      hasNewer: state.hasNewer || kept.length < all.length,
+      loadingOlder: false,
+    };
   });
 };
 
+function loadOlderMessages() {
+  const { messages, hasOlder, loadingOlder } = store.getState();
+  const oldest = messages.find(m => typeof m.seq === 'number');
+
+  if (!hasOlder || loadingOlder || !oldest || typeof globalThis.__postNativeMessage__ !== 'function')
+    return;
+
+  store.setState({ loadingOlder: true });
+  globalThis.__postNativeMessage__('getMessages', oldest.seq, kPageSize);
+}
+
+function loadNewestMessages() {
+  if (!store.getState().hasNewer || typeof globalThis.__postNativeMessage__ !== 'function')
+    return;
+
+  globalThis.__postNativeMessage__('getMessages', 0, kPageSize);
+}
+
+// Sent once when the editor is ready and then for every change, including host
+// automation. Only the parameters that changed are included.
+globalThis.__receiveParameterValues__ = function(values) {
+  store.setState(state => ({ parameters: { ...state.parameters, ...values } }));
+};
+
+function setParameterValue(paramId, value) {
+  store.setState(state => ({ parameters: { ...state.parameters, [paramId]: value } }));
+
+  if (typeof globalThis.__postNativeMessage__ === 'function') {
+    globalThis.__postNativeMessage__('setParameterValue', paramId, value);
+  }
+}
+
+globalThis.__receivePerformanceStats__ = function(stats) {
+  store.setState({ performance: stats });
+};
+
+function resetPerformanceStats() {
+  if (typeof globalThis.__postNativeMessage__ === 'function') {
+    globalThis.__postNativeMessage__('resetPerformanceStats');
+  }
+}
+
+globalThis.__receiveTraceState__ = function(trace) {
+  store.setState(state => ({ trace: { active: trace.active, file: trace.file || state.trace.file } }));
+};
+
+function toggleTrace() {
+  if (typeof globalThis.__postNativeMessage__ === 'function') {
+    globalThis.__postNativeMessage__(store.getState().trace.active ? 'stopTrace' : 'startTrace');
+  }
+}
+
+function collectGarbage() {
+  if (typeof globalThis.__postNativeMessage__ === 'function') {
+    globalThis.__postNativeMessage__('collectGarbage');
+  }
+}
+
+globalThis.__receiveCaptureState__ = function(capturing) {
+  store.setState({ capturing });
+};
+
+function shareAudio(seconds) {
+  if (typeof globalThis.__postNativeMessage__ === 'function') {
+    globalThis.__postNativeMessage__('captureAudio', seconds, store.getState().currentUser);
+  }
+}
+
+// Searches run natively over the whole history; only the newest matches and
+// per-sender counts come back. Responses to superseded queries are dropped.
+let searchRequestId = 0;
+let searchTimer = null;
+
+globalThis.__receiveSearchResults__ = function(results) {
+  if (results.id !== searchRequestId)
+    return;
+
+  store.setState(state => ({
+    search: {
+      ...state.search,
+      results: { ...results, messages: results.messages.map(toUiMessage).reverse() },
+    },
+  }));
+};
+
+function searchMessages(text, nickname) {
+  store.setState(state => ({
+    search: { text, nickname, results: text.trim() || nickname ? state.search.results : null },
+  }));
+
+  clearTimeout(searchTimer);
+
+  if (!text.trim() && !nickname) {
+    ++searchRequestId;
+    return;
+  }
+
+  searchTimer = setTimeout(() => {
+    if (typeof globalThis.__postNativeMessage__ === 'function') {
+      globalThis.__postNativeMessage__('searchMessages', JSON.stringify({
+        id: ++searchRequestId,
+        text,
+        nickname,
+        limit: kPageSize,
+      }));
+    }
+  }, 100);
+}
+
+setInterval(() => {
+  if (typeof globalThis.__postNativeMessage__ === 'function') {
+    globalThis.__postNativeMessage__('getPerformanceStats');
+  }
+}, 1000);
+
 globalThis.__receiveError__ = (err) => {
   errorStore.setState({ error: err });
 };
@@ -69,6 +250,14 @@ function App(props) {
       sendMessage={sendMessage}
       setMessages={store.getState().setMessages}
       addMessage={store.getState().addMessage}
+      loadOlderMessages={loadOlderMessages}
+      loadNewestMessages={loadNewestMessages}
+      setParameterValue={setParameterValue}
+      resetPerformanceStats={resetPerformanceStats}
+      shareAudio={shareAudio}
+      collectGarbage={collectGarbage}
+      toggleTrace={toggleTrace}
+      searchMessages={searchMessages}
       resetErrorState={() => errorStore.setState({ error: null })} />
   );
 }